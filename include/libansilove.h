@@ -0,0 +1,138 @@
+//
+//  libansilove.h
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef libansilove_h
+#define libansilove_h
+
+// file types
+#define ANSILOVE_ANSI    0
+#define ANSILOVE_ARTWORX 1
+#define ANSILOVE_BINARY  2
+#define ANSILOVE_ICEDRAW 3
+#define ANSILOVE_PCBOARD 4
+#define ANSILOVE_TUNDRA  5
+#define ANSILOVE_XBIN    6
+
+// rendering modes for ANSi files
+#define ANSILOVE_MODE_NORMAL      0
+#define ANSILOVE_MODE_CED         1
+#define ANSILOVE_MODE_TRANSPARENT 2
+#define ANSILOVE_MODE_WORKBENCH   3
+
+// Output formats: a PNG file, or a raw frame that can be mapped and used
+// as it is. A frame starts with a header of ANSILOVE_FRAME_SIZE bytes:
+// "ALFB", the width and the height as 32-bit little-endian numbers, the
+// format, the bytes per pixel and the number of palette entries as a
+// 16-bit little-endian number. ANSILOVE_INDEXED frames go on with their
+// palette, 4 bytes of red, green, blue and alpha per entry. Then come the
+// rows, top to bottom without padding, of 4 bytes of red, green, blue and
+// alpha, 3 bytes of red, green and blue, or a palette entry per pixel.
+#define ANSILOVE_PNG     0
+#define ANSILOVE_RGBA    1
+#define ANSILOVE_RGB     2
+#define ANSILOVE_INDEXED 3
+
+#define ANSILOVE_FRAME_SIZE 16
+
+// PNG row filters, they have the values of libpng's PNG_FILTER_* flags
+#define ANSILOVE_FILTER_NONE     0x08
+#define ANSILOVE_FILTER_SUB      0x10
+#define ANSILOVE_FILTER_UP       0x20
+#define ANSILOVE_FILTER_ADAPTIVE 0xf8
+
+// error codes, ansilove_error() describes them
+#define ANSILOVE_OK               0
+#define ANSILOVE_INVALID_PARAM    1
+#define ANSILOVE_FORMAT_ERROR     2
+#define ANSILOVE_MEMORY_ERROR     3
+#define ANSILOVE_FILE_READ_ERROR  4
+#define ANSILOVE_FILE_WRITE_ERROR 5
+#define ANSILOVE_PNG_ERROR        6
+#define ANSILOVE_RANGE_ERROR      7
+
+// upper limit for the images made from one file, the image itself and
+// up to 8 other scales
+#define ANSILOVE_OUTPUTS_MAX 9
+
+// How a file is rendered. ansilove_init() sets the defaults, font is a
+// font name as given to -f, level a zlib level from 0 to 9 or -1 for
+// zlib's default and filters a set of ANSILOVE_FILTER_* flags.
+struct ansilove_options {
+    int32_t type;
+    const char *font;
+    int32_t bits;
+    int32_t columns;
+    int32_t mode;
+    bool icecolors;
+    bool diz;
+    int32_t threads;
+    int32_t level;
+    int32_t filters;
+};
+
+// An image made from the file, factor times as large as the file, or
+// for thumbnails divisor times as small. It is written to path, or kept
+// in data when path is NULL. Rendering fills in the rest: the image size,
+// the length of data and the processor time making the image took.
+struct ansilove_output {
+    int32_t factor;
+    int32_t divisor;
+    int32_t format;
+    char *path;
+    unsigned char *data;
+    size_t length;
+    int32_t width;
+    int32_t height;
+    double seconds;
+};
+
+// A file to render and the images to make from it. ansilove_init() asks
+// for one PNG image at the size of the file, kept in memory. characters
+// and drawn count the characters an ANSi file printed and the cells
+// drawn for them once overdrawn ones are dropped.
+struct ansilove_ctx {
+    const unsigned char *buffer;
+    size_t length;
+    struct ansilove_output outputs[ANSILOVE_OUTPUTS_MAX];
+    int32_t count;
+    int32_t characters;
+    int32_t drawn;
+    int error;
+
+    // set by ansilove_loadfile()
+    unsigned char *loaded;
+    size_t loaded_length;
+    bool mapped;
+};
+
+// Every function returns ANSILOVE_OK or an error code, which is also
+// kept in ctx->error. None of them exits or prints anything.
+int ansilove_init(struct ansilove_ctx *ctx, struct ansilove_options *options);
+int ansilove_loadfile(struct ansilove_ctx *ctx, const char *path);
+
+// sets the type of options from the extension of name, .diz files are
+// ANSi files rendered only as wide as their longest line
+int ansilove_filetype(struct ansilove_options *options, const char *name);
+
+// renders ctx->buffer into every output of ctx, a SAUCE record at the
+// end of the buffer is left out
+int ansilove_render(struct ansilove_ctx *ctx, const struct ansilove_options *options);
+
+// frees what ansilove_loadfile() and ansilove_render() allocated
+void ansilove_clean(struct ansilove_ctx *ctx);
+
+const char *ansilove_error(const struct ansilove_ctx *ctx);
+
+#endif
@@ -11,27 +11,197 @@
 
 #include "ansilove.h"
 
-// shared method for drawing characters
-void drawchar(gdImagePtr im, const unsigned char *font_data, int32_t bits,
-                int32_t height, int32_t position_x, int32_t position_y,
-                int32_t background, int32_t foreground, unsigned char character)
+// cell kernel picked for the running CPU on first use, by whichever
+// thread gets there first
+static const struct blitKernel *kernel = NULL;
+static pthread_once_t kernelOnce = PTHREAD_ONCE_INIT;
+
+static void selectkernel(void)
+{
+    kernel = alBlitSelect();
+}
+
+// shared method for drawing characters, copies the glyph rows from the
+// atlas straight into the palette or truecolor pixel rows of the canvas
+void alDrawChar(gdImagePtr im, const struct glyphAtlas *atlas, int32_t position_x,
+                int32_t position_y, int32_t background, int32_t foreground, int32_t character)
 {
+    int32_t bits = atlas->bits, height = atlas->height;
     int32_t column, line;
+    int32_t x = position_x * bits, y = position_y * height;
+    int32_t first_column = 0, last_column = bits;
+    int32_t first_line = 0, last_line = height;
+
+    // clip the character cell against the canvas, like libgd does per pixel
+    if (x < 0) {
+        first_column = -x;
+    }
+    if (x + bits > im->sx) {
+        last_column = im->sx - x;
+    }
+    if (y < 0) {
+        first_line = -y;
+    }
+    if (y + height > im->sy) {
+        last_line = im->sy - y;
+    }
+
+    const unsigned char *mask = atlas->masks + (character * height + first_line) * bits;
+
+    pthread_once(&kernelOnce, selectkernel);
+
+    // unclipped rows go through the cell kernel
+    if (first_column == 0 && last_column == bits) {
+        if (im->trueColor) {
+            kernel->cell32(im->tpixels, x, y + first_line, mask, bits,
+                           last_line - first_line, foreground, background);
+        } else {
+            kernel->cell8(im->pixels, x, y + first_line, mask, bits,
+                          last_line - first_line, foreground, background);
+        }
+        return;
+    }
+
+    for (line = first_line; line < last_line; line++, mask += bits) {
+        if (im->trueColor) {
+            int *row = im->tpixels[y + line] + x;
+
+            for (column = first_column; column < last_column; column++) {
+                row[column] = mask[column] ? foreground : background;
+            }
+        } else {
+            unsigned char *row = im->pixels[y + line] + x;
+
+            for (column = first_column; column < last_column; column++) {
+                row[column] = mask[column] ? foreground : background;
+            }
+        }
+    }
+}
+
+// a screen being drawn, shared by all threads drawing it
+struct drawJob {
+    gdImagePtr im;
+    const struct glyphAtlas *atlas;
+    const struct screen *scr;
+    const int32_t *backgrounds;
+    const int32_t *foregrounds;
+    int32_t columns;
+    int32_t first_row;
+    int32_t rows;
+    int32_t band_rows;
+    int32_t next_row;
+    int32_t drawn;
+    pthread_mutex_t lock;
+};
+
+// draws bands of rows until none are left, the cells of different rows
+// never share pixels, so bands can be drawn in any order and at once
+static void *drawbands(void *arg)
+{
+    struct drawJob *job = arg;
+    const struct screenCell *cell;
+    int32_t first_row, position_x, position_y, drawn;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        first_row = job->next_row;
+        job->next_row += job->band_rows;
+        pthread_mutex_unlock(&job->lock);
 
-    gdImageFilledRectangle(im, position_x * bits, position_y*height, position_x * bits +
-                           bits - 1, position_y * height + height - 1, background);
+        if (first_row >= job->rows) {
+            return NULL;
+        }
 
-    for (line = 0; line < height; line++) {
-        for (column = 0; column < bits; column++) {
+        drawn = 0;
 
-            if ((font_data[line+character*height] & (0x80 >> column)) != 0) {
-                gdImageSetPixel(im, position_x * bits + column, position_y*height + line, foreground);
+        for (position_y = first_row; position_y < job->rows &&
+             position_y < first_row + job->band_rows; position_y++) {
+            cell = job->scr->cells +
+                (size_t)(job->first_row + position_y) * job->scr->columns;
 
-                if (bits==9 && column==7 && character > 191 && character < 224)
-                {
-                    gdImageSetPixel(im, position_x * bits + 8, position_y * height + line, foreground);
+            for (position_x = 0; position_x < job->columns; position_x++, cell++) {
+                if (!cell->written) {
+                    continue;
                 }
+
+                alDrawChar(job->im, job->atlas, position_x, position_y,
+                         job->backgrounds[cell->attribute >> 4],
+                         job->foregrounds[cell->attribute & 15], cell->character);
+                drawn++;
             }
         }
+
+        pthread_mutex_lock(&job->lock);
+        job->drawn += drawn;
+        pthread_mutex_unlock(&job->lock);
+    }
+}
+
+// draws the written cells of a screen from text row first_row on, as far
+// down as the canvas goes, backgrounds and foregrounds map the 16 attribute
+// colors to canvas colors, returns the number of cells drawn
+int32_t alDrawScreen(gdImagePtr im, const struct glyphAtlas *atlas, const struct screen *scr,
+                int32_t first_row, const int32_t *backgrounds, const int32_t *foregrounds,
+                int32_t threads)
+{
+    pthread_t workers[DRAW_THREADS_MAX];
+    int32_t started = 0, loop;
+    struct drawJob job;
+
+    job.im = im;
+    job.atlas = atlas;
+    job.scr = scr;
+    job.backgrounds = backgrounds;
+    job.foregrounds = foregrounds;
+    job.first_row = first_row;
+    job.next_row = 0;
+    job.drawn = 0;
+
+    // cells entirely outside the canvas are never visible
+    job.columns = (im->sx + atlas->bits - 1) / atlas->bits;
+    if (job.columns > scr->columns) {
+        job.columns = scr->columns;
+    }
+
+    job.rows = (im->sy + atlas->height - 1) / atlas->height;
+    if (job.rows > scr->rows - first_row) {
+        job.rows = scr->rows - first_row;
+    }
+
+    if (threads > DRAW_THREADS_MAX) {
+        threads = DRAW_THREADS_MAX;
+    }
+
+    // bands are smaller when there are too few rows for every thread to
+    // get a whole one, and there is no point in having more threads
+    // than bands
+    job.band_rows = threads > 0 ? (job.rows + threads - 1) / threads : 0;
+    if (job.band_rows > DRAW_BAND_ROWS || job.band_rows < 1) {
+        job.band_rows = DRAW_BAND_ROWS;
+    }
+
+    if (threads > (job.rows + job.band_rows - 1) / job.band_rows) {
+        threads = (job.rows + job.band_rows - 1) / job.band_rows;
+    }
+
+    pthread_mutex_init(&job.lock, NULL);
+
+    // the calling thread draws as well, if starting a thread fails the
+    // remaining ones simply take more bands
+    for (loop = 1; loop < threads; loop++) {
+        if (pthread_create(&workers[started], NULL, drawbands, &job) == 0) {
+            started++;
+        }
+    }
+
+    drawbands(&job);
+
+    for (loop = 0; loop < started; loop++) {
+        pthread_join(workers[loop], NULL);
     }
+
+    pthread_mutex_destroy(&job.lock);
+
+    return job.drawn;
 }
@@ -15,10 +15,13 @@
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 #include <gd.h>
 #include "config.h"
 #include "fonts.h"
-#include "explode.h"
+#include "atlas.h"
+#include "blit.h"
+#include "screen.h"
 #include "output.h"
 #include "sauce.h"
 
@@ -29,9 +32,17 @@
 #ifndef ansilove_h
 #define ansilove_h
 
+// most text rows a drawing thread takes at a time
+#define DRAW_BAND_ROWS 16
+
+// upper limit for the number of drawing threads
+#define DRAW_THREADS_MAX 256
+
 // prototypes
-void drawchar(gdImagePtr im, const unsigned char *font_data, int32_t bits,
-                int32_t height, int32_t position_x, int32_t position_y,
-                int32_t background, int32_t foreground, unsigned char character);
+void alDrawChar(gdImagePtr im, const struct glyphAtlas *atlas, int32_t position_x,
+                int32_t position_y, int32_t background, int32_t foreground, int32_t character);
+int32_t alDrawScreen(gdImagePtr im, const struct glyphAtlas *atlas, const struct screen *scr,
+                int32_t first_row, const int32_t *backgrounds, const int32_t *foregrounds,
+                int32_t threads);
 
 #endif
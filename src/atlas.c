@@ -0,0 +1,93 @@
+//
+//  atlas.c
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include "atlas.h"
+
+// enough for every built-in font in both 8 and 9 bits
+#define ATLAS_CACHE_SIZE 64
+
+static struct {
+    const unsigned char *font_data;
+    struct glyphAtlas atlas;
+} atlasCache[ATLAS_CACHE_SIZE];
+
+// guards the cache, files may be converted on several threads at once
+static pthread_mutex_t atlasLock = PTHREAD_MUTEX_INITIALIZER;
+
+bool alBuildAtlas(struct glyphAtlas *atlas, const unsigned char *font_data,
+                  int32_t glyphs, int32_t bits, int32_t height)
+{
+    int32_t glyph, line, column;
+
+    atlas->glyphs = glyphs;
+    atlas->bits = bits;
+    atlas->height = height;
+
+    atlas->masks = malloc(glyphs * height * bits);
+    if (atlas->masks == NULL) {
+        return false;
+    }
+
+    unsigned char *mask = atlas->masks;
+
+    for (glyph = 0; glyph < glyphs; glyph++) {
+        // the 9th column repeats the 8th one for block characters only
+        bool blockchar = bits == 9 && (glyph & 255) > 191 && (glyph & 255) < 224;
+
+        for (line = 0; line < height; line++) {
+            unsigned char font_row = font_data[glyph * height + line];
+
+            for (column = 0; column < 8; column++) {
+                *mask++ = (font_row & (0x80 >> column)) ? 0xff : 0x00;
+            }
+
+            if (bits == 9) {
+                *mask++ = (blockchar && (font_row & 1)) ? 0xff : 0x00;
+            }
+        }
+    }
+
+    return true;
+}
+
+void alFreeAtlas(struct glyphAtlas *atlas)
+{
+    free(atlas->masks);
+    atlas->masks = NULL;
+}
+
+const struct glyphAtlas *alFontAtlas(const struct fontStruct *fontData, int32_t bits)
+{
+    int32_t i;
+
+    pthread_mutex_lock(&atlasLock);
+
+    for (i = 0; i < ATLAS_CACHE_SIZE && atlasCache[i].font_data != NULL; i++) {
+        if (atlasCache[i].font_data == fontData->font_data &&
+            atlasCache[i].atlas.bits == bits &&
+            atlasCache[i].atlas.height == fontData->height) {
+            pthread_mutex_unlock(&atlasLock);
+            return &atlasCache[i].atlas;
+        }
+    }
+
+    if (i == ATLAS_CACHE_SIZE ||
+        !alBuildAtlas(&atlasCache[i].atlas, fontData->font_data, 256, bits, fontData->height)) {
+        pthread_mutex_unlock(&atlasLock);
+        return NULL;
+    }
+
+    atlasCache[i].font_data = fontData->font_data;
+
+    pthread_mutex_unlock(&atlasLock);
+
+    return &atlasCache[i].atlas;
+}
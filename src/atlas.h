@@ -0,0 +1,45 @@
+//
+//  atlas.h
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "fonts.h"
+
+#ifndef atlas_h
+#define atlas_h
+
+// A glyph atlas holds every glyph of a font expanded to one byte per
+// pixel, 0xff where the foreground shows and 0x00 for the background.
+// Glyph rows are bits bytes wide, the 9th column of block characters
+// is already resolved, so drawing a cell is a masked copy of its rows.
+
+struct glyphAtlas {
+    unsigned char *masks;
+    int32_t glyphs;
+    int32_t bits;
+    int32_t height;
+};
+
+// returns false when there is no memory for the masks
+bool alBuildAtlas(struct glyphAtlas *atlas, const unsigned char *font_data,
+                  int32_t glyphs, int32_t bits, int32_t height);
+void alFreeAtlas(struct glyphAtlas *atlas);
+
+// Returns the atlas for a font picked by alSelectFont(). Built-in fonts
+// stay around, so their atlases are only built once and then shared,
+// also between threads. Returns NULL when the atlas can't be built.
+const struct glyphAtlas *alFontAtlas(const struct fontStruct *fontData, int32_t bits);
+
+#endif
@@ -0,0 +1,150 @@
+//
+//  blit.c
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include "blit.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BLIT_X86
+#include <immintrin.h>
+#endif
+
+static void cell8_scalar(unsigned char **pixels, int32_t x, int32_t y,
+                         const unsigned char *mask, int32_t bits, int32_t lines,
+                         int32_t foreground, int32_t background)
+{
+    int32_t column, line;
+
+    for (line = 0; line < lines; line++, mask += bits) {
+        unsigned char *row = pixels[y + line] + x;
+
+        for (column = 0; column < bits; column++) {
+            row[column] = mask[column] ? foreground : background;
+        }
+    }
+}
+
+static void cell32_scalar(int **tpixels, int32_t x, int32_t y,
+                          const unsigned char *mask, int32_t bits, int32_t lines,
+                          int32_t foreground, int32_t background)
+{
+    int32_t column, line;
+
+    for (line = 0; line < lines; line++, mask += bits) {
+        int *row = tpixels[y + line] + x;
+
+        for (column = 0; column < bits; column++) {
+            row[column] = mask[column] ? foreground : background;
+        }
+    }
+}
+
+static const struct blitKernel blitScalar = { "scalar", cell8_scalar, cell32_scalar };
+
+#ifdef BLIT_X86
+
+// the first 8 pixels of a row go through vector registers, the 9th
+// column of 9 bit fonts is handled on its own
+
+__attribute__((target("sse2")))
+static void cell8_sse2(unsigned char **pixels, int32_t x, int32_t y,
+                       const unsigned char *mask, int32_t bits, int32_t lines,
+                       int32_t foreground, int32_t background)
+{
+    __m128i fg = _mm_set1_epi8((char)foreground);
+    __m128i bg = _mm_set1_epi8((char)background);
+    int32_t line;
+
+    for (line = 0; line < lines; line++, mask += bits) {
+        unsigned char *row = pixels[y + line] + x;
+        __m128i m = _mm_loadl_epi64((const __m128i *)mask);
+
+        _mm_storel_epi64((__m128i *)row,
+                         _mm_or_si128(_mm_and_si128(m, fg), _mm_andnot_si128(m, bg)));
+
+        if (bits == 9) {
+            row[8] = mask[8] ? foreground : background;
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+static void cell32_sse2(int **tpixels, int32_t x, int32_t y,
+                        const unsigned char *mask, int32_t bits, int32_t lines,
+                        int32_t foreground, int32_t background)
+{
+    __m128i fg = _mm_set1_epi32(foreground);
+    __m128i bg = _mm_set1_epi32(background);
+    int32_t line;
+
+    for (line = 0; line < lines; line++, mask += bits) {
+        int *row = tpixels[y + line] + x;
+        __m128i m = _mm_loadl_epi64((const __m128i *)mask);
+
+        // widen the 0x00/0xff mask bytes to 32 bits
+        m = _mm_unpacklo_epi8(m, m);
+        __m128i lo = _mm_unpacklo_epi16(m, m);
+        __m128i hi = _mm_unpackhi_epi16(m, m);
+
+        _mm_storeu_si128((__m128i *)row,
+                         _mm_or_si128(_mm_and_si128(lo, fg), _mm_andnot_si128(lo, bg)));
+        _mm_storeu_si128((__m128i *)(row + 4),
+                         _mm_or_si128(_mm_and_si128(hi, fg), _mm_andnot_si128(hi, bg)));
+
+        if (bits == 9) {
+            row[8] = mask[8] ? foreground : background;
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void cell32_avx2(int **tpixels, int32_t x, int32_t y,
+                        const unsigned char *mask, int32_t bits, int32_t lines,
+                        int32_t foreground, int32_t background)
+{
+    __m256i fg = _mm256_set1_epi32(foreground);
+    __m256i bg = _mm256_set1_epi32(background);
+    int32_t line;
+
+    for (line = 0; line < lines; line++, mask += bits) {
+        int *row = tpixels[y + line] + x;
+
+        // sign extension turns 0xff mask bytes into all ones
+        __m256i m = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)mask));
+
+        _mm256_storeu_si256((__m256i *)row, _mm256_blendv_epi8(bg, fg, m));
+
+        if (bits == 9) {
+            row[8] = mask[8] ? foreground : background;
+        }
+    }
+}
+
+static const struct blitKernel blitSSE2 = { "sse2", cell8_sse2, cell32_sse2 };
+
+// palette rows are only 8 bytes wide, wider registers don't help there
+static const struct blitKernel blitAVX2 = { "avx2", cell8_sse2, cell32_avx2 };
+
+#endif
+
+const struct blitKernel *alBlitSelect(void)
+{
+#ifdef BLIT_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        return &blitAVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return &blitSSE2;
+    }
+#endif
+    return &blitScalar;
+}
@@ -0,0 +1,37 @@
+//
+//  blit.h
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef blit_h
+#define blit_h
+
+// Cell kernels expand lines rows of glyph atlas masks into pixels,
+// writing foreground where the mask is set and background elsewhere.
+// Rows are bits (8 or 9) pixels wide and start at column x of the
+// palette (pixels) or truecolor (tpixels) rows from y on. On x86 an
+// SSE2 or AVX2 kernel is picked at runtime, a portable one otherwise.
+
+struct blitKernel {
+    const char *name;
+    void (*cell8)(unsigned char **pixels, int32_t x, int32_t y,
+                  const unsigned char *mask, int32_t bits, int32_t lines,
+                  int32_t foreground, int32_t background);
+    void (*cell32)(int **tpixels, int32_t x, int32_t y,
+                   const unsigned char *mask, int32_t bits, int32_t lines,
+                   int32_t foreground, int32_t background);
+};
+
+// the fastest kernel the running CPU supports
+const struct blitKernel *alBlitSelect(void);
+
+#endif
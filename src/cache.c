@@ -0,0 +1,193 @@
+//
+//  cache.c
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include "cache.h"
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "config.h"
+
+// changes whenever the same options draw a different image, so entries
+// of older renderers are never used
+#define CACHE_FORMAT 1
+
+// 64-bit FNV-1a
+#define CACHE_OFFSET 0xcbf29ce484222325ULL
+#define CACHE_PRIME  0x100000001b3ULL
+
+// the path of an entry is the cache directory, a slash and 16 hex digits,
+// without a suffix as entries are PNG files or raw frames alike
+#define CACHE_NAME_SIZE 17
+
+bool cacheOpen(struct renderCache *cache, const char *dir)
+{
+    struct stat st;
+
+    if (mkdir(dir, 0777) == -1 && errno != EEXIST) {
+        return false;
+    }
+
+    if (stat(dir, &st) == -1 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+
+    cache->dir = dir;
+    cache->hits = 0;
+    cache->misses = 0;
+    pthread_mutex_init(&cache->lock, NULL);
+
+    return true;
+}
+
+static uint64_t cacheHash(uint64_t hash, const void *data, size_t length)
+{
+    const unsigned char *bytes = data;
+
+    for (size_t loop = 0; loop < length; loop++) {
+        hash ^= bytes[loop];
+        hash *= CACHE_PRIME;
+    }
+
+    return hash;
+}
+
+void cacheKeys(const struct ansilove_ctx *ctx, const struct ansilove_options *options,
+               uint64_t *keys)
+{
+    char text[256];
+    int length;
+
+    // the input is hashed once, every output adds its own scale to it
+    uint64_t hash = cacheHash(CACHE_OFFSET, ctx->buffer, ctx->length);
+
+    length = snprintf(text, sizeof(text), "%s %d %s %d %d %d %d %d %d %d %d",
+                      VERSION, CACHE_FORMAT, options->font ? options->font : "80x25",
+                      options->type, options->bits, options->columns, options->mode,
+                      options->icecolors, options->diz, options->level, options->filters);
+    hash = cacheHash(hash, text, length);
+
+    for (int32_t loop = 0; loop < ctx->count; loop++) {
+        const struct ansilove_output *output = &ctx->outputs[loop];
+
+        length = snprintf(text, sizeof(text), " %d %d %d",
+                          output->factor, output->divisor, output->format);
+        keys[loop] = cacheHash(hash, text, length);
+    }
+}
+
+static void cacheEntry(const struct renderCache *cache, uint64_t key, char *entry, size_t size)
+{
+    snprintf(entry, size, "%s/%016" PRIx64, cache->dir, key);
+}
+
+// copies the file at path to fd, which is closed
+static bool cacheCopy(const char *path, int fd)
+{
+    unsigned char buffer[65536];
+    ssize_t count, written;
+    bool copied = true;
+    int in = open(path, O_RDONLY);
+
+    if (in == -1 || fd == -1) {
+        copied = false;
+    }
+
+    while (copied && (count = read(in, buffer, sizeof(buffer))) != 0) {
+        if (count == -1) {
+            copied = errno == EINTR;
+            continue;
+        }
+
+        for (ssize_t done = 0; copied && done < count; done += written) {
+            written = write(fd, buffer + done, count - done);
+
+            if (written == -1) {
+                copied = errno == EINTR;
+                written = 0;
+            }
+        }
+    }
+
+    if (in != -1) {
+        close(in);
+    }
+
+    if (fd != -1 && close(fd) == -1) {
+        copied = false;
+    }
+
+    return copied;
+}
+
+bool cacheFetch(struct renderCache *cache, const struct ansilove_ctx *ctx,
+                const uint64_t *keys)
+{
+    size_t size = strlen(cache->dir) + CACHE_NAME_SIZE + 1;
+    char *entry = malloc(size);
+    bool found = entry != NULL;
+    int32_t loop;
+
+    // an image is only taken from the cache once all of them are there
+    for (loop = 0; found && loop < ctx->count; loop++) {
+        cacheEntry(cache, keys[loop], entry, size);
+        found = ctx->outputs[loop].path && access(entry, R_OK) == 0;
+    }
+
+    for (loop = 0; found && loop < ctx->count; loop++) {
+        cacheEntry(cache, keys[loop], entry, size);
+        found = cacheCopy(entry, open(ctx->outputs[loop].path,
+                                      O_WRONLY | O_CREAT | O_TRUNC, 0666));
+    }
+
+    free(entry);
+
+    pthread_mutex_lock(&cache->lock);
+    if (found) {
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    return found;
+}
+
+void cacheStore(struct renderCache *cache, const struct ansilove_ctx *ctx,
+                const uint64_t *keys)
+{
+    size_t size = strlen(cache->dir) + CACHE_NAME_SIZE + 1;
+    char *entry = malloc(size);
+    char *temp = malloc(size + 7);
+
+    // entries appear at once, so a run on other files or in another
+    // process never reads half of one, a cache that can't be written
+    // only costs the next run some time
+    for (int32_t loop = 0; entry && temp && loop < ctx->count; loop++) {
+        cacheEntry(cache, keys[loop], entry, size);
+        snprintf(temp, size + 7, "%s.XXXXXX", entry);
+
+        if (access(entry, F_OK) == 0) {
+            continue;
+        }
+
+        int fd = mkstemp(temp);
+
+        if (fd != -1 && (!cacheCopy(ctx->outputs[loop].path, fd) || rename(temp, entry) == -1)) {
+            unlink(temp);
+        }
+    }
+
+    free(entry);
+    free(temp);
+}
@@ -0,0 +1,53 @@
+//
+//  cache.h
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "libansilove.h"
+
+#ifndef cache_h
+#define cache_h
+
+// a directory of rendered images, named after what they were made of,
+// shared by every file of a run
+struct renderCache {
+    const char *dir;
+    int32_t hits;
+    int32_t misses;
+    pthread_mutex_t lock;
+};
+
+// Creates the cache directory if there is none yet, false if it can't be
+// used.
+bool cacheOpen(struct renderCache *cache, const char *dir);
+
+// Computes the key of every output of ctx, a hash of the input and of
+// every option that changes the image. The file type has to be set.
+void cacheKeys(const struct ansilove_ctx *ctx, const struct ansilove_options *options,
+               uint64_t *keys);
+
+// Copies the cached image of every output to its path and counts a hit.
+// Unless all of them are cached, a miss is counted and the outputs are
+// left to be rendered. Entries are copied rather than linked, as a later
+// run writing over a linked output would change the entry as well.
+bool cacheFetch(struct renderCache *cache, const struct ansilove_ctx *ctx,
+                const uint64_t *keys);
+
+// Keeps the rendered outputs of ctx for the next time.
+void cacheStore(struct renderCache *cache, const struct ansilove_ctx *ctx,
+                const uint64_t *keys);
+
+#endif
@@ -25,34 +25,6 @@ struct fontStruct {
     bool isAmigaFont;
 };
 
-void alSelectFont(struct fontStruct* fontData, char *font);
-
-// Binary font and image data.
-
-unsigned char font_pc_80x25[4096];
-unsigned char font_pc_80x50[2048];
-unsigned char font_pc_baltic[4096];
-unsigned char font_pc_cyrillic[4096];
-unsigned char font_pc_french_canadian[4096];
-unsigned char font_pc_greek[4096];
-unsigned char font_pc_greek_869[4096];
-unsigned char font_pc_hebrew[4096];
-unsigned char font_pc_icelandic[4096];
-unsigned char font_pc_latin1[4096];
-unsigned char font_pc_latin2[4096];
-unsigned char font_pc_nordic[4096];
-unsigned char font_pc_portuguese[4096];
-unsigned char font_pc_russian[4096];
-unsigned char font_pc_terminus[4096];
-unsigned char font_pc_turkish[4096];
-
-unsigned char font_amiga_microknight[4096];
-unsigned char font_amiga_microknight_plus[4096];
-unsigned char font_amiga_mosoul[4096];
-unsigned char font_amiga_pot_noodle[4096];
-unsigned char font_amiga_topaz_1200[4096];
-unsigned char font_amiga_topaz_1200_plus[4096];
-unsigned char font_amiga_topaz_500[4096];
-unsigned char font_amiga_topaz_500_plus[4096];
+void alSelectFont(struct fontStruct* fontData, const char *font);
 
 #endif
@@ -0,0 +1,325 @@
+//
+//  libansilove.c
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#define _XOPEN_SOURCE 700
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ansilove.h"
+#include "strtolower.h"
+
+#include "loaders/ansi.h"
+#include "loaders/artworx.h"
+#include "loaders/binary.h"
+#include "loaders/icedraw.h"
+#include "loaders/pcboard.h"
+#include "loaders/tundra.h"
+#include "loaders/xbin.h"
+
+static const char *errors[] = {
+    [ANSILOVE_OK] = "Success",
+    [ANSILOVE_INVALID_PARAM] = "Invalid parameter",
+    [ANSILOVE_FORMAT_ERROR] = "Invalid input file format",
+    [ANSILOVE_MEMORY_ERROR] = "Memory allocation error",
+    [ANSILOVE_FILE_READ_ERROR] = "Can't read input file",
+    [ANSILOVE_FILE_WRITE_ERROR] = "Can't write output file",
+    [ANSILOVE_PNG_ERROR] = "PNG encoding error",
+    [ANSILOVE_RANGE_ERROR] = "Input file too large"
+};
+
+// the loaders, in the order of the ANSILOVE_* file types
+static int (*const loaders[])(struct ansilove_ctx *, const unsigned char *, int32_t,
+                              const struct ansilove_options *) = {
+    [ANSILOVE_ANSI] = alAnsi,
+    [ANSILOVE_ARTWORX] = alArtworx,
+    [ANSILOVE_BINARY] = alBinary,
+    [ANSILOVE_ICEDRAW] = alIcedraw,
+    [ANSILOVE_PCBOARD] = alPcboard,
+    [ANSILOVE_TUNDRA] = alTundra,
+    [ANSILOVE_XBIN] = alXbin
+};
+
+int ansilove_init(struct ansilove_ctx *ctx, struct ansilove_options *options)
+{
+    if (ctx == NULL || options == NULL) {
+        return ANSILOVE_INVALID_PARAM;
+    }
+
+    memset(ctx, 0, sizeof(struct ansilove_ctx));
+    memset(options, 0, sizeof(struct ansilove_options));
+
+    // a single PNG at the size of the file, kept in memory
+    ctx->outputs[0].factor = 1;
+    ctx->outputs[0].divisor = 1;
+    ctx->outputs[0].format = ANSILOVE_PNG;
+    ctx->count = 1;
+
+    options->type = ANSILOVE_ANSI;
+    options->bits = 8;
+    options->columns = 160;
+    options->mode = ANSILOVE_MODE_NORMAL;
+    options->threads = 1;
+    options->level = -1;
+    options->filters = ANSILOVE_FILTER_NONE;
+
+    return ANSILOVE_OK;
+}
+
+// frees what was loaded, but leaves the outputs as they are
+static void unload(struct ansilove_ctx *ctx)
+{
+    if (ctx->mapped) {
+        munmap(ctx->loaded, ctx->loaded_length);
+    } else {
+        free(ctx->loaded);
+    }
+
+    if (ctx->buffer == ctx->loaded) {
+        ctx->buffer = NULL;
+        ctx->length = 0;
+    }
+
+    ctx->loaded = NULL;
+    ctx->loaded_length = 0;
+    ctx->mapped = false;
+}
+
+int ansilove_loadfile(struct ansilove_ctx *ctx, const char *path)
+{
+    struct stat input_stat;
+    unsigned char *buffer = NULL;
+    bool mapped = false;
+    int saved;
+
+    if (ctx == NULL || path == NULL) {
+        return ANSILOVE_INVALID_PARAM;
+    }
+
+    unload(ctx);
+
+    int input_fd = open(path, O_RDONLY);
+
+    if (input_fd == -1) {
+        return ctx->error = ANSILOVE_FILE_READ_ERROR;
+    }
+
+    if (fstat(input_fd, &input_stat)) {
+        saved = errno;
+        close(input_fd);
+        errno = saved;
+        return ctx->error = ANSILOVE_FILE_READ_ERROR;
+    }
+
+    size_t length = input_stat.st_size;
+
+    // map the file read-only, loaders consume it in place and never
+    // read past its end, so no terminating byte is needed
+    if (length > 0) {
+        buffer = mmap(NULL, length, PROT_READ, MAP_PRIVATE, input_fd, 0);
+
+        if (buffer != MAP_FAILED) {
+            mapped = true;
+        } else {
+            // files that can't be mapped are read into memory instead
+            size_t done = 0;
+            ssize_t count = 0;
+
+            buffer = malloc(length);
+
+            while (buffer != NULL && done < length &&
+                   (count = read(input_fd, buffer + done, length - done)) > 0) {
+                done += count;
+            }
+
+            if (buffer == NULL || done < length) {
+                saved = buffer == NULL ? ENOMEM : count == 0 ? EIO : errno;
+                free(buffer);
+                close(input_fd);
+                errno = saved;
+                return ctx->error = buffer == NULL ? ANSILOVE_MEMORY_ERROR :
+                    ANSILOVE_FILE_READ_ERROR;
+            }
+        }
+    }
+
+    // the mapping stays valid without the file
+    close(input_fd);
+
+    ctx->loaded = buffer;
+    ctx->loaded_length = length;
+    ctx->mapped = mapped;
+    ctx->buffer = buffer;
+    ctx->length = length;
+
+    return ctx->error = ANSILOVE_OK;
+}
+
+int ansilove_filetype(struct ansilove_options *options, const char *name)
+{
+    char fext[8] = "";
+
+    if (options == NULL || name == NULL) {
+        return ANSILOVE_INVALID_PARAM;
+    }
+
+    // longer extensions never match
+    const char *dot = strrchr(name, '.');
+
+    if (dot && strlen(dot) < sizeof(fext)) {
+        alStrToLower(strcpy(fext, dot));
+    }
+
+    if (!strcmp(fext, ".pcb")) {
+        options->type = ANSILOVE_PCBOARD;
+    } else if (!strcmp(fext, ".bin")) {
+        options->type = ANSILOVE_BINARY;
+    } else if (!strcmp(fext, ".adf")) {
+        options->type = ANSILOVE_ARTWORX;
+    } else if (!strcmp(fext, ".idf")) {
+        options->type = ANSILOVE_ICEDRAW;
+    } else if (!strcmp(fext, ".tnd")) {
+        options->type = ANSILOVE_TUNDRA;
+    } else if (!strcmp(fext, ".xb")) {
+        options->type = ANSILOVE_XBIN;
+    } else {
+        options->type = ANSILOVE_ANSI;
+    }
+
+    options->diz = !strcmp(fext, ".diz");
+
+    return ANSILOVE_OK;
+}
+
+// whether the options and outputs make sense, before anything is drawn
+static bool validate(const struct ansilove_ctx *ctx, const struct ansilove_options *options)
+{
+    int32_t loop;
+
+    if (options->type < ANSILOVE_ANSI || options->type > ANSILOVE_XBIN ||
+        (options->bits != 8 && options->bits != 9) || options->columns < 1 ||
+        options->mode < ANSILOVE_MODE_NORMAL || options->mode > ANSILOVE_MODE_WORKBENCH ||
+        options->threads < 1 || options->threads > DRAW_THREADS_MAX ||
+        options->level < -1 || options->level > 9 ||
+        options->filters & ~ANSILOVE_FILTER_ADAPTIVE || !options->filters) {
+        return false;
+    }
+
+    if (ctx->count < 1 || ctx->count > ANSILOVE_OUTPUTS_MAX) {
+        return false;
+    }
+
+    for (loop = 0; loop < ctx->count; loop++) {
+        const struct ansilove_output *output = &ctx->outputs[loop];
+
+        if (output->factor < 1 || output->factor > 16 ||
+            output->divisor < 1 || output->divisor > 64 ||
+            (output->factor > 1 && output->divisor > 1) ||
+            output->format < ANSILOVE_PNG || output->format > ANSILOVE_INDEXED) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int ansilove_render(struct ansilove_ctx *ctx, const struct ansilove_options *options)
+{
+    struct ansilove_options render;
+    size_t length;
+    int32_t loop;
+
+    if (ctx == NULL || options == NULL) {
+        return ANSILOVE_INVALID_PARAM;
+    }
+
+    if (!validate(ctx, options) || (ctx->buffer == NULL && ctx->length > 0)) {
+        return ctx->error = ANSILOVE_INVALID_PARAM;
+    }
+
+    if (ctx->length > INT32_MAX) {
+        return ctx->error = ANSILOVE_RANGE_ERROR;
+    }
+
+    // images of an earlier render are replaced
+    for (loop = 0; loop < ANSILOVE_OUTPUTS_MAX; loop++) {
+        free(ctx->outputs[loop].data);
+        ctx->outputs[loop].data = NULL;
+        ctx->outputs[loop].length = 0;
+        ctx->outputs[loop].width = ctx->outputs[loop].height = 0;
+        ctx->outputs[loop].seconds = 0;
+    }
+
+    ctx->characters = ctx->drawn = 0;
+
+    // default to 80x25 font if none is given
+    render = *options;
+
+    if (render.font == NULL) {
+        render.font = "80x25";
+    }
+
+    // a SAUCE record at the end is not part of the file
+    sauce *record = alSauceParseBuffer(ctx->buffer, ctx->length);
+
+    if (record == NULL) {
+        return ctx->error = ANSILOVE_MEMORY_ERROR;
+    }
+
+    length = ctx->length;
+
+    // the record, its comment block and the EOF character before them,
+    // if any, are left out, but never more than the buffer holds
+    if (!strcmp(record->ID, SAUCE_ID)) {
+        size_t sauceSize = RECORD_SIZE +
+            (record->comments > 0 ? 5 + COMMENT_SIZE * record->comments : 0);
+
+        length = sauceSize < length ? length - sauceSize : 0;
+
+        if (length > 0 && ctx->buffer[length - 1] == 0x1a) {
+            length--;
+        }
+    }
+
+    alSauceFree(record);
+
+    return ctx->error = loaders[render.type](ctx, ctx->buffer, length, &render);
+}
+
+void ansilove_clean(struct ansilove_ctx *ctx)
+{
+    int32_t loop;
+
+    if (ctx == NULL) {
+        return;
+    }
+
+    for (loop = 0; loop < ANSILOVE_OUTPUTS_MAX; loop++) {
+        free(ctx->outputs[loop].data);
+        ctx->outputs[loop].data = NULL;
+        ctx->outputs[loop].length = 0;
+    }
+
+    unload(ctx);
+
+    ctx->error = ANSILOVE_OK;
+}
+
+const char *ansilove_error(const struct ansilove_ctx *ctx)
+{
+    if (ctx == NULL || ctx->error < ANSILOVE_OK || ctx->error > ANSILOVE_RANGE_ERROR) {
+        return errors[ANSILOVE_INVALID_PARAM];
+    }
+
+    return errors[ctx->error];
+}
@@ -12,364 +12,423 @@
 #define _XOPEN_SOURCE 700
 #define _NETBSD_SOURCE
 #include <string.h>
+#include <ctype.h>
 
 #include "ansi.h"
 
-void ansi(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, char *font, int32_t bits, char *mode, bool icecolors, char *fext, bool createRetinaRep)
+// interpreter states
+#define ANSI_GROUND 0
+#define ANSI_CSI    1
+
+// character classes of the ground state
+#define ANSI_PRINT  0
+#define ANSI_CR     1
+#define ANSI_LF     2
+#define ANSI_TAB    3
+#define ANSI_SUB    4
+#define ANSI_ESC    5
+#define ANSI_SKIP   6
+
+static const unsigned char ansiClasses[256] = {
+    [9] = ANSI_TAB, [10] = ANSI_LF, [13] = ANSI_CR, [26] = ANSI_SUB, [27] = ANSI_ESC
+};
+
+// Converts one sequence parameter in place, the same way strtonum()
+// with a 0 to INT32_MAX range did: anything that is not a number in
+// that range counts as 0.
+static int32_t ansiNumber(const unsigned char *str, int32_t length)
 {
-    // ladies and gentlemen, it's type declaration time
-    struct fontStruct fontData;
+    int32_t i = 0;
+    int64_t value = 0;
+    bool negative = false;
 
-    int32_t columns = 80;
+    while (i < length && isspace(str[i])) {
+        i++;
+    }
 
-    bool isDizFile = false;
-    bool ced = false;
-    bool transparent = false;
-    bool workbench = false;
+    if (i < length && (str[i] == '+' || str[i] == '-')) {
+        negative = str[i] == '-';
+        i++;
+    }
 
-    const char *errstr;
+    // no digits at all
+    if (i == length) {
+        return 0;
+    }
 
-    // font selection
-    alSelectFont(&fontData, font);
+    for (; i < length; i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            return 0;
+        }
+
+        value = value * 10 + (str[i] - '0');
 
-    // to deal with the bits flag, we declared handy bool types
-    if (!strcmp(mode, "ced")) {
-        ced = true;
+        if (value > INT32_MAX) {
+            return 0;
+        }
     }
-    else if (!strcmp(mode, "transparent")) {
-        transparent = true;
+
+    return negative ? 0 : (int32_t)value;
+}
+
+// Splits the content of a sequence at ';' and converts every parameter
+// into params, which must hold ANSI_SEQUENCE_PARAMS entries. Returns the
+// number of parameters, an empty sequence has a single 0 parameter.
+static int32_t ansiParams(const unsigned char *seq, int32_t length, int32_t *params)
+{
+    int32_t count = 0, start = 0, i;
+
+    // the content used to be copied as a C string, so it ends at a NUL
+    const unsigned char *nul = memchr(seq, '\0', length);
+    if (nul != NULL) {
+        length = nul - seq;
     }
-    else if (!strcmp(mode, "workbench")) {
-        workbench = true;
+
+    for (i = 0; i <= length && count < ANSI_SEQUENCE_PARAMS; i++) {
+        if (i == length || seq[i] == ';') {
+            params[count++] = ansiNumber(seq + start, i - start);
+            start = i + 1;
+        }
     }
 
-    // check if current file has a .diz extension
-    if (!strcmp(fext, ".diz")) {
-        isDizFile = true;
+    return count;
+}
+
+int alAnsi(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options)
+{
+    // ladies and gentlemen, it's type declaration time
+    struct fontStruct fontData;
+
+    int32_t columns = 80;
+
+    bool isDizFile = options->diz;
+    bool ced = options->mode == ANSILOVE_MODE_CED;
+    bool transparent = options->mode == ANSILOVE_MODE_TRANSPARENT;
+    bool workbench = options->mode == ANSILOVE_MODE_WORKBENCH;
+
+    // font selection
+    alSelectFont(&fontData, options->font);
+    const struct glyphAtlas *atlas = alFontAtlas(&fontData, options->bits);
+
+    if (!atlas) {
+        return ANSILOVE_MEMORY_ERROR;
     }
 
     // libgd image pointers
     gdImagePtr canvas;
 
     // ANSi processing loops
-    int32_t loop = 0, ansi_sequence_loop, seq_graphics_loop;
+    int32_t loop = 0, seq_graphics_loop;
 
     // character definitions
-    int32_t current_character, next_character, character;
-    unsigned char ansi_sequence_character;
+    int32_t current_character;
 
     // default color values
     int32_t background = 0, foreground = 7;
 
     // text attributes
-    bool bold = false, underline = false, italics = false, blink = false;
+    bool bold = false, blink = false;
 
     // positions
     int32_t position_x = 0, position_y = 0, position_x_max = 0, position_y_max = 0;
     int32_t saved_position_y = 0, saved_position_x = 0;
 
     // sequence parsing variables
+    int32_t state = ANSI_GROUND, seqStart = 0;
     int32_t seqValue, seqArrayCount, seq_line, seq_column;
-    char *seqGrab;
-    char **seqArray;
+    int32_t seqArray[ANSI_SEQUENCE_PARAMS];
 
-    // ANSi buffer structure array definition
-    int32_t structIndex = 0;
-    struct ansiChar *ansi_buffer, *temp;
+    // Amiga fonts don't print form feeds
+    unsigned char ansiClass[256];
+    memcpy(ansiClass, ansiClasses, sizeof(ansiClass));
 
-    // ANSi buffer dynamic memory allocation
-    ansi_buffer = malloc(sizeof(struct ansiChar));
+    if (fontData.isAmigaFont) {
+        ansiClass[12] = ANSI_SKIP;
+    }
+
+    // the ANSi screen, characters beyond column 80 are never visible
+    struct screen ansi_screen;
+    int32_t characters = 0;
+
+    alScreenInit(&ansi_screen, 80, alOutputRows(80 * options->bits, fontData.height));
 
-    // ANSi interpreter
+    // ANSi interpreter, a state machine with two states: ground, where
+    // runs of printable characters are stored in bulk and control
+    // characters are dispatched through the class table, and control
+    // sequence, which collects parameter and intermediate bytes up to
+    // the final byte
     while (loop < inputFileSize)
     {
         current_character = inputFileBuffer[loop];
-        next_character = inputFileBuffer[loop + 1];
 
-        if (position_x==80)
+        if (state == ANSI_CSI)
         {
-            position_y++;
-            position_x=0;
-        }
-
-        // CR + LF
-        if (current_character == 13 && next_character == 10) {
-            position_y++;
-            position_x = 0;
-            loop++;
-        }
+            // parameter and intermediate bytes
+            if (current_character >= 0x20 && current_character < 0x40)
+            {
+                loop++;
+                continue;
+            }
 
-        // LF
-        if (current_character == 10)
-        {
-            position_y++;
-            position_x = 0;
-        }
+            // anything but a final byte cancels the sequence
+            state = ANSI_GROUND;
 
-        // tab
-        if (current_character == 9)
-        {
-            position_x += 8;
-        }
+            if (current_character < 0x40 || current_character > 0x7e)
+            {
+                continue;
+            }
 
-        // sub
-        if (current_character == 26)
-        {
-            break;
-        }
+            int32_t seqLength = loop - seqStart;
+            loop++;
 
-        // ANSi sequence
-        if (current_character == 27 && next_character == 91)
-        {
-            for (ansi_sequence_loop = 0; ansi_sequence_loop < 12; ansi_sequence_loop++)
+            // cursor position
+            if (current_character == 'H' || current_character == 'f')
             {
-                ansi_sequence_character = inputFileBuffer[loop + 2 + ansi_sequence_loop];
+                // convert the sequence's content to integers
+                seqArrayCount = ansiParams(inputFileBuffer + seqStart, seqLength, seqArray);
 
-                // cursor position
-                if (ansi_sequence_character == 'H' || ansi_sequence_character == 'f')
-                {
-                    // create substring from the sequence's content
-                    seqGrab = strndup((char *)inputFileBuffer + loop + 2, ansi_sequence_loop);
+                if (seqArrayCount > 1) {
+                    seq_line = seqArray[0];
+                    seq_column = seqArray[1];
 
-                    // create sequence content array
-                    seqArrayCount = explode(&seqArray, ';', seqGrab);
-                    free(seqGrab);
+                    // finally set the positions
+                    position_y = seq_line-1;
+                    position_x = seq_column-1;
+                }
+                else {
+                    // no coordinates specified? we move to the home position
+                    position_y = 0;
+                    position_x = 0;
+                }
+                continue;
+            }
 
-                    if (seqArrayCount > 1) {
-                        // convert grabbed sequence content to integers
-                        seq_line = strtonum(seqArray[0], 0, INT32_MAX, &errstr);
-                        seq_column = strtonum(seqArray[1], 0, INT32_MAX, &errstr);
+            // cursor up
+            if (current_character == 'A')
+            {
+                // now get escape sequence's position value, a list of parameters counts as 0
+                seqArrayCount = ansiParams(inputFileBuffer + seqStart, seqLength, seqArray);
+                seq_line = seqArrayCount == 1 ? seqArray[0] : 0;
 
-                        // finally set the positions
-                        position_y = seq_line-1;
-                        position_x = seq_column-1;
-                    }
-                    else {
-                        // no coordinates specified? we move to the home position
-                        position_y = 0;
-                        position_x = 0;
-                    }
-                    loop+=ansi_sequence_loop+2;
-                    break;
-                }
+                position_y -= seq_line ? seq_line : 1;
+                continue;
+            }
 
-                // cursor up
-                if (ansi_sequence_character=='A')
-                {
-                    // create substring from the sequence's content
-                    seqGrab = strndup((char *)inputFileBuffer + loop + 2, ansi_sequence_loop);
+            // cursor down
+            if (current_character == 'B')
+            {
+                // now get escape sequence's position value, a list of parameters counts as 0
+                seqArrayCount = ansiParams(inputFileBuffer + seqStart, seqLength, seqArray);
+                seq_line = seqArrayCount == 1 ? seqArray[0] : 0;
 
-                    // now get escape sequence's position value
-                    int32_t seq_line = strtonum(seqGrab, 0, INT32_MAX, &errstr);
-                    free(seqGrab);
+                position_y += seq_line ? seq_line : 1;
+                continue;
+            }
 
-                    position_y -= seq_line ? seq_line : 1;
+            // cursor forward
+            if (current_character == 'C')
+            {
+                // now get escape sequence's position value, a list of parameters counts as 0
+                seqArrayCount = ansiParams(inputFileBuffer + seqStart, seqLength, seqArray);
+                seq_column = seqArrayCount == 1 ? seqArray[0] : 0;
 
-                    loop+=ansi_sequence_loop+2;
-                    break;
-                }
+                position_x += seq_column ? seq_column : 1;
 
-                // cursor down
-                if (ansi_sequence_character=='B')
+                if (position_x>80)
                 {
-                    // create substring from the sequence's content
-                    seqGrab = strndup((char *)inputFileBuffer + loop + 2, ansi_sequence_loop);
+                    position_x=80;
+                }
+                continue;
+            }
 
-                    // now get escape sequence's position value
-                    int32_t seq_line = strtonum(seqGrab, 0, INT32_MAX, &errstr);
-                    free(seqGrab);
+            // cursor backward
+            if (current_character == 'D')
+            {
+                // now get escape sequence's content length, a list of parameters counts as 0
+                seqArrayCount = ansiParams(inputFileBuffer + seqStart, seqLength, seqArray);
+                seq_column = seqArrayCount == 1 ? seqArray[0] : 0;
 
-                    position_y += seq_line ? seq_line : 1;
+                position_x -= seq_column ? seq_column : 1;
 
-                    loop+=ansi_sequence_loop+2;
-                    break;
+                if (position_x < 0)
+                {
+                    position_x = 0;
                 }
+                continue;
+            }
 
-                // cursor forward
-                if (ansi_sequence_character=='C')
-                {
-                    // create substring from the sequence's content
-                    seqGrab = strndup((char *)inputFileBuffer + loop + 2, ansi_sequence_loop);
+            // save cursor position
+            if (current_character == 's')
+            {
+                saved_position_y = position_y;
+                saved_position_x = position_x;
+                continue;
+            }
 
-                    // now get escape sequence's position value
-                    int32_t seq_column = strtonum(seqGrab, 0, INT32_MAX, &errstr);
-                    free(seqGrab);
+            // restore cursor position
+            if (current_character == 'u')
+            {
+                position_y = saved_position_y;
+                position_x = saved_position_x;
+                continue;
+            }
 
-                    position_x += seq_column ? seq_column : 1;
+            // erase display
+            if (current_character == 'J')
+            {
+                // convert the sequence's content to an integer, a list counts as 0
+                seqArrayCount = ansiParams(inputFileBuffer + seqStart, seqLength, seqArray);
 
-                    if (position_x>80)
-                    {
-                        position_x=80;
-                    }
+                if (seqArrayCount == 1 && seqArray[0] == 2)
+                {
+                    position_x=0;
+                    position_y=0;
+
+                    position_x_max=0;
+                    position_y_max=0;
 
-                    loop+=ansi_sequence_loop+2;
-                    break;
+                    // reset ansi screen, keeping its memory around
+                    alScreenClear(&ansi_screen);
+                    characters=0;
                 }
+                continue;
+            }
 
-                // cursor backward
-                if (ansi_sequence_character=='D')
-                {
-                    // create substring from the sequence's content
-                    seqGrab = strndup((char *)inputFileBuffer + loop + 2, ansi_sequence_loop);
+            // set graphics mode
+            if (current_character == 'm')
+            {
+                // convert the sequence's content to integers
+                seqArrayCount = ansiParams(inputFileBuffer + seqStart, seqLength, seqArray);
 
-                    // now get escape sequence's content length
-                    int32_t seq_column = strtonum(seqGrab, 0, INT32_MAX, &errstr);
-                    free(seqGrab);
+                // a loophole in limbo
+                for (seq_graphics_loop = 0; seq_graphics_loop < seqArrayCount; seq_graphics_loop++)
+                {
+                    seqValue = seqArray[seq_graphics_loop];
 
-                    position_x -= seq_column ? seq_column : 1;
+                    if (seqValue == 0)
+                    {
+                        background = 0;
+                        foreground = 7;
+                        bold = false;
+                        blink = false;
+                    }
 
-                    if (position_x < 0)
+                    if (seqValue == 1)
                     {
-                        position_x = 0;
+                        if (!workbench)
+                        {
+                            foreground+=8;
+                        }
+                        bold = true;
                     }
 
-                    loop+=ansi_sequence_loop+2;
-                    break;
-                }
+                    if (seqValue == 5)
+                    {
+                        if (!workbench)
+                        {
+                            background+=8;
+                        }
+                        blink = true;
+                    }
 
-                // save cursor position
-                if (ansi_sequence_character=='s')
-                {
-                    saved_position_y = position_y;
-                    saved_position_x = position_x;
+                    if (seqValue > 29 && seqValue < 38)
+                    {
+                        foreground = seqValue - 30;
 
-                    loop+=ansi_sequence_loop+2;
-                    break;
-                }
+                        if (bold)
+                        {
+                            foreground+=8;
+                        }
+                    }
 
-                // restore cursor position
-                if (ansi_sequence_character=='u')
-                {
-                    position_y = saved_position_y;
-                    position_x = saved_position_x;
+                    if (seqValue > 39 && seqValue < 48)
+                    {
+                        background = seqValue - 40;
 
-                    loop+=ansi_sequence_loop+2;
-                    break;
+                        if (blink && options->icecolors)
+                        {
+                            background+=8;
+                        }
+                    }
                 }
+                continue;
+            }
 
-                // erase display
-                if (ansi_sequence_character=='J')
-                {
-                    // create substring from the sequence's content
-                    seqGrab = strndup((char *)inputFileBuffer + loop + 2, ansi_sequence_loop);
-
-                    // convert grab to an integer
-                    int32_t eraseDisplayInt = strtonum(seqGrab, 0, INT32_MAX, &errstr);
-                    free(seqGrab);
-
-                    if (eraseDisplayInt == 2)
-                    {
-                        position_x=0;
-                        position_y=0;
+            // everything else, like cursor (de)activation (Amiga ANSi)
+            // and set mode and reset mode sequences, is skipped
+            continue;
+        }
 
-                        position_x_max=0;
-                        position_y_max=0;
+        if (position_x==80)
+        {
+            position_y++;
+            position_x=0;
+        }
 
-                        // reset ansi buffer
-                        free(ansi_buffer);
-                        ansi_buffer = malloc(sizeof(struct ansiChar));
-                        structIndex=0;
-                    }
-                    loop+=ansi_sequence_loop+2;
-                    break;
-                }
+        switch (ansiClass[current_character])
+        {
+        case ANSI_CR:
+            // CR + LF, a lone CR is ignored
+            if (loop + 1 < inputFileSize && inputFileBuffer[loop + 1] == 10)
+            {
+                position_y++;
+                position_x = 0;
+                loop++;
+            }
+            loop++;
+            continue;
 
-                // set graphics mode
-                if (ansi_sequence_character=='m')
-                {
-                        // create substring from the sequence's content
-                        seqGrab = strndup((char *)inputFileBuffer + loop + 2, ansi_sequence_loop);
+        case ANSI_LF:
+            position_y++;
+            position_x = 0;
+            loop++;
+            continue;
 
-                        // create sequence content array
-                        seqArrayCount = explode(&seqArray, ';', seqGrab);
-                        free(seqGrab);
+        case ANSI_TAB:
+            position_x += 8;
+            loop++;
+            continue;
 
-                        // a loophole in limbo
-                        for (seq_graphics_loop = 0; seq_graphics_loop < seqArrayCount; seq_graphics_loop++)
-                        {
-                            // convert split content value to integer
-                            seqValue = strtonum(seqArray[seq_graphics_loop], 0, INT32_MAX, &errstr);
-
-                            if (seqValue == 0)
-                            {
-                                background = 0;
-                                foreground = 7;
-                                bold = false;
-                                underline = false;
-                                italics = false;
-                                blink = false;
-                            }
-
-                            if (seqValue == 1)
-                            {
-                                if (!workbench)
-                                {
-                                    foreground+=8;
-                                }
-                                bold = true;
-                            }
-
-                            if (seqValue == 3)
-                            {
-                                italics = true;
-                            }
-
-                            if (seqValue == 4)
-                            {
-                                underline = true;
-                            }
-
-                            if (seqValue == 5)
-                            {
-                                if (!workbench)
-                                {
-                                    background+=8;
-                                }
-                                blink = true;
-                            }
-
-                            if (seqValue > 29 && seqValue < 38)
-                            {
-                                foreground = seqValue - 30;
-
-                                if (bold)
-                                {
-                                    foreground+=8;
-                                }
-                            }
-
-                            if (seqValue > 39 && seqValue < 48)
-                            {
-                                background = seqValue - 40;
-
-                                if (blink && icecolors)
-                                {
-                                    background+=8;
-                                }
-                            }
-                        }
+        case ANSI_SUB:
+            // end of the art, SAUCE or other trailing data may follow
+            loop = inputFileSize;
+            continue;
 
-                    loop+=ansi_sequence_loop+2;
-                    break;
-                }
+        case ANSI_ESC:
+            // control sequence introducer, a lone ESC is printed
+            if (loop + 1 < inputFileSize && inputFileBuffer[loop + 1] == '[')
+            {
+                state = ANSI_CSI;
+                seqStart = loop + 2;
+                loop += 2;
+                continue;
+            }
+            break;
 
-                // cursor (de)activation (Amiga ANSi)
-                if (ansi_sequence_character == 'p')
-                {
-                    loop+=ansi_sequence_loop+2;
-                    break;
-                }
+        case ANSI_SKIP:
+            // not printed, but the position still counts for the canvas size
+            if (position_x>position_x_max)
+            {
+                position_x_max=position_x;
+            }
 
-                // skipping set mode and reset mode sequences
-                if (ansi_sequence_character == 'h' || ansi_sequence_character == 'l')
-                {
-                    loop+=ansi_sequence_loop+2;
-                    break;
-                }
+            if (position_y>position_y_max)
+            {
+                position_y_max=position_y;
             }
+            loop++;
+            continue;
         }
-        else if (current_character!=10 && current_character!=13 && current_character!=9)
+
+        // a run of printable characters, wrapping at column 80
+        do
         {
+            if (position_x==80)
+            {
+                position_y++;
+                position_x=0;
+            }
+
             // record number of columns and lines used
             if (position_x>position_x_max)
             {
@@ -381,27 +440,15 @@ void ansi(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
                 position_y_max=position_y;
             }
 
-            // write current character in ansiChar structure
-            if (!fontData.isAmigaFont || (current_character != 12 && current_character != 13))
-            {
-                // reallocate structure array memory
-                temp = realloc(ansi_buffer, (structIndex + 1) * sizeof(struct ansiChar));
-                ansi_buffer = temp;
-
-                ansi_buffer[structIndex].background = background;
-                ansi_buffer[structIndex].foreground = foreground;
-                ansi_buffer[structIndex].current_character = current_character;
-                ansi_buffer[structIndex].bold = bold;
-                ansi_buffer[structIndex].italics = italics;
-                ansi_buffer[structIndex].underline = underline;
-                ansi_buffer[structIndex].position_x = position_x;
-                ansi_buffer[structIndex].position_y = position_y;
-
-                structIndex++;
-                position_x++;
-            }
-        }
-        loop++;
+            // write current character to the screen, a later character
+            // written to the same cell simply replaces it
+            alScreenPut(&ansi_screen, position_x, position_y, inputFileBuffer[loop],
+                        (foreground & 15) | (background & 15) << 4);
+
+            characters++;
+            position_x++;
+            loop++;
+        } while (loop < inputFileSize && ansiClass[inputFileBuffer[loop]] == ANSI_PRINT);
     }
 
     // allocate image buffer memory
@@ -417,15 +464,29 @@ void ansi(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
         columns = fmin(position_x_max,80);
     }
 
-    // create that damn thingy
-    canvas = gdImageCreate(columns * bits,(position_y_max)*fontData.height);
+    // create that damn thingy, it only holds the palette, the image is
+    // drawn and written a band at a time
+    if (ansi_screen.error != ANSILOVE_OK) {
+        int error = ansi_screen.error;
+
+        alScreenFree(&ansi_screen);
+        return error;
+    }
+
+    // nothing was printed
+    if (position_y_max * fontData.height <= 0) {
+        alScreenFree(&ansi_screen);
+        return ANSILOVE_FORMAT_ERROR;
+    }
+
+    canvas = gdImageCreate(columns * options->bits, 1);
 
     if (!canvas) {
-        perror("Can't allocate ANSi buffer image memory");
-        exit(6);
+        alScreenFree(&ansi_screen);
+        return ANSILOVE_MEMORY_ERROR;
     }
 
-    int32_t colors[16];
+    int32_t colors[16], ced_foregrounds[16];
 
     int32_t ced_background = 0, ced_foreground = 0;
 
@@ -433,12 +494,16 @@ void ansi(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
     {
         ced_background = gdImageColorAllocate(canvas, 170, 170, 170);
         ced_foreground = gdImageColorAllocate(canvas, 0, 0, 0);
-        gdImageFill(canvas, 0, 0, ced_background);
+
+        // every color is drawn black on gray
+        for (loop = 0; loop < 16; loop++)
+        {
+            colors[loop] = ced_background;
+            ced_foregrounds[loop] = ced_foreground;
+        }
     }
     else if (workbench)
     {
-        gdImageFill(canvas, 0, 0, 0);
-
         colors[0] = gdImageColorAllocate(canvas, 170, 170, 170);
         colors[1] = gdImageColorAllocate(canvas, 0, 0, 0);
         colors[2] = gdImageColorAllocate(canvas, 255, 255, 255);
@@ -479,41 +544,21 @@ void ansi(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
         colors[15] = gdImageColorAllocate(canvas, 255, 255, 255);
     }
 
-    // even more definitions, sigh
-    int32_t ansiBufferItems = structIndex;
-
-    // render ANSi
-    for (loop = 0; loop < ansiBufferItems; loop++)
-    {
-        // grab ANSi char from our structure array
-        background = ansi_buffer[loop].background;
-        foreground = ansi_buffer[loop].foreground;
-        character = ansi_buffer[loop].current_character;
-        bold = ansi_buffer[loop].bold;
-        italics = ansi_buffer[loop].italics;
-        underline = ansi_buffer[loop].underline;
-        position_x = ansi_buffer[loop].position_x;
-        position_y = ansi_buffer[loop].position_y;
-
-        if (ced) {
-            drawchar(canvas, fontData.font_data, bits, fontData.height,
-                   position_x, position_y, ced_background, ced_foreground, character);
-        } else {
-            drawchar(canvas, fontData.font_data, bits, fontData.height,
-                   position_x, position_y, colors[background], colors[foreground], character);
-        }
-
-    }
-
     // transparent flag used?
     if (transparent)
     {
         gdImageColorTransparent(canvas, 0);
     }
 
-    // create output image
-    output(canvas, outputFile, retinaout, createRetinaRep);
+    // render ANSi and create output image
+    ctx->characters = characters;
+
+    int error = alOutputScreen(canvas, position_y_max * fontData.height,
+                             atlas, &ansi_screen, colors, ced ? ced_foregrounds : colors,
+                             ctx, options);
 
     // free memory
-    free(ansi_buffer);
+    alScreenFree(&ansi_screen);
+
+    return error;
 }
@@ -14,18 +14,9 @@
 #ifndef ansi_h
 #define ansi_h
 
-// Character structure
-struct ansiChar {
-    int32_t position_x;
-    int32_t position_y;
-    int32_t background;
-    int32_t foreground;
-    int32_t current_character;
-    bool bold;
-    bool italics;
-    bool underline;
-};
+// maximum number of parameters in a sequence, further ones are ignored
+#define ANSI_SEQUENCE_PARAMS 16
 
-void ansi(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, char *font, int32_t bits, char *mode, bool icecolors, char *fext, bool createRetinaRep);
+int alAnsi(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options);
 
 #endif
@@ -11,39 +11,49 @@
 
 #include "artworx.h"
 
-void artworx(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, bool createRetinaRep)
+int alArtworx(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options)
 {
-    const unsigned char *font_data;
-    unsigned char *font_data_adf;
+    struct glyphAtlas atlas;
 
     // libgd image pointers
     gdImagePtr canvas;
 
-    // create ADF instance
-    canvas = gdImageCreate(640,(((inputFileSize - 192 - 4096 -1) / 2) / 80) * 16);
+    // the palette and the font come first
+    if (inputFileSize < 192 + 4096 + 1) {
+        return ANSILOVE_FORMAT_ERROR;
+    }
+
+    int32_t canvas_height = (((inputFileSize - 192 - 4096 -1) / 2) / 80) * 16;
+
+    // not even one row of characters
+    if (canvas_height <= 0) {
+        return ANSILOVE_FORMAT_ERROR;
+    }
+
+    // process ADF font
+    if (!alBuildAtlas(&atlas, inputFileBuffer+193, 256, 8, 16)) {
+        return ANSILOVE_MEMORY_ERROR;
+    }
+
+    // create ADF instance, the canvas only holds the palette, the image is
+    // drawn and written a band at a time
+    canvas = gdImageCreate(640, 1);
 
     // error output
     if (!canvas) {
-        perror("Can't allocate buffer image memory");
-        exit (7);
+        alFreeAtlas(&atlas);
+        return ANSILOVE_MEMORY_ERROR;
     }
 
     // ADF color palette array
     int32_t adf_colors[16] = { 0, 1, 2, 3, 4, 5, 20, 7, 56, 57, 58, 59, 60, 61, 62, 63 };
 
+    // the 16 colors are allocated first, attributes are canvas colors
+    int32_t colors[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
     int32_t loop;
     int32_t index;
 
-    // process ADF font
-    font_data_adf = (unsigned char *) malloc(sizeof(unsigned char)*4096);
-    if (font_data_adf == NULL) {
-        perror("Memory error");
-        exit (7);
-    }
-    memcpy(font_data_adf,inputFileBuffer+193,4096);
-
-    font_data=font_data_adf;
-
     // process ADF palette
     for (loop = 0; loop < 16; loop++)
     {
@@ -56,11 +66,14 @@ void artworx(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
     gdImageColorAllocate(canvas, 0, 0, 0);
 
     // process ADF
+    struct screen adf_screen;
     int32_t position_x = 0, position_y = 0;
-    int32_t character, attribute, foreground, background;
     loop = 192 + 4096 + 1;
 
-    while(loop < inputFileSize)
+    alScreenInit(&adf_screen, 80, alOutputRows(640, 16));
+
+    // a trailing odd byte would be below the canvas anyway
+    while(loop + 1 < inputFileSize)
     {
         if (position_x == 80)
         {
@@ -68,21 +81,26 @@ void artworx(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
             position_y++;
         }
 
-        character = inputFileBuffer[loop];
-        attribute = inputFileBuffer[loop+1];
-
-        background = (attribute & 240) >> 4;
-        foreground = attribute & 15;
-
-        drawchar(canvas, font_data, 8, 16, position_x, position_y, background, foreground, character);
+        alScreenPut(&adf_screen, position_x, position_y,
+                    inputFileBuffer[loop], inputFileBuffer[loop+1]);
 
         position_x++;
         loop+=2;
     }
 
-    // create output file
-    output(canvas, outputFile, retinaout, createRetinaRep);
+    // render ADF and create output file
+    int error = adf_screen.error;
+
+    if (error == ANSILOVE_OK) {
+        error = alOutputScreen(canvas, canvas_height, &atlas, &adf_screen, colors, colors,
+                             ctx, options);
+    } else {
+        gdImageDestroy(canvas);
+    }
 
     // nuke garbage
-    free(font_data_adf);
+    alFreeAtlas(&atlas);
+    alScreenFree(&adf_screen);
+
+    return error;
 }
@@ -14,6 +14,6 @@
 #ifndef artworx_h
 #define artworx_h
 
-void artworx(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, bool createRetinaRep);
+int alArtworx(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options);
 
 #endif
@@ -11,24 +11,35 @@
 
 #include "binary.h"
 
-void binary(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, int32_t columns, char *font, int32_t bits, bool icecolors, bool createRetinaRep)
+int alBinary(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options)
 {
     // some type declarations
     struct fontStruct fontData;
+    int32_t columns = options->columns;
 
     // font selection
-    alSelectFont(&fontData, font);
+    alSelectFont(&fontData, options->font);
+    const struct glyphAtlas *atlas = alFontAtlas(&fontData, options->bits);
+
+    if (!atlas) {
+        return ANSILOVE_MEMORY_ERROR;
+    }
 
     // libgd image pointers
     gdImagePtr canvas;
 
-    // allocate buffer image memory
-    canvas = gdImageCreate(columns * bits,
-                              ((inputFileSize / 2) / columns * fontData.height));
+    int32_t canvas_height = (inputFileSize / 2) / columns * fontData.height;
+
+    // the canvas only holds the palette, the image is drawn and written a
+    // band at a time
+    if (canvas_height <= 0) {
+        return ANSILOVE_FORMAT_ERROR;
+    }
+
+    canvas = gdImageCreate(columns * options->bits, 1);
 
     if (!canvas) {
-        perror("Error, can't allocate buffer image memory");
-        exit (6);
+        return ANSILOVE_MEMORY_ERROR;
     }
 
     // allocate black color
@@ -54,11 +65,24 @@ void binary(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
     colors[14] = gdImageColorAllocate(canvas, 255, 255, 85);
     colors[15] = gdImageColorAllocate(canvas, 255, 255, 255);
 
+    // without iCE colors, high intensity backgrounds are drawn dark
+    int32_t backgrounds[16];
+    int32_t loop;
+
+    for (loop = 0; loop < 16; loop++)
+    {
+        backgrounds[loop] = colors[loop > 8 && !options->icecolors ? loop - 8 : loop];
+    }
+
     // process binary
-    int32_t character, attribute, background, foreground;
-    int32_t loop = 0, position_x = 0, position_y = 0;
+    struct screen binary_screen;
+    int32_t position_x = 0, position_y = 0;
+
+    alScreenInit(&binary_screen, columns, alOutputRows(columns * options->bits, fontData.height));
+    loop = 0;
 
-    while (loop < inputFileSize)
+    // a trailing odd byte would be below the canvas anyway
+    while (loop + 1 < inputFileSize)
     {
         if (position_x == columns)
         {
@@ -66,24 +90,25 @@ void binary(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
             position_y++;
         }
 
-        character = inputFileBuffer[loop];
-        attribute = inputFileBuffer[loop+1];
-
-        background = (attribute & 240) >> 4;
-        foreground = (attribute & 15);
-
-        if (background > 8 && !icecolors)
-        {
-            background -= 8;
-        }
-
-        drawchar(canvas, fontData.font_data, bits, fontData.height,
-                   position_x, position_y, colors[background], colors[foreground], character);
+        alScreenPut(&binary_screen, position_x, position_y,
+                    inputFileBuffer[loop], inputFileBuffer[loop+1]);
 
         position_x++;
         loop+=2;
     }
 
-    // create output image
-    output(canvas, outputFile, retinaout, createRetinaRep);
+    // render binary and create output image
+    int error = binary_screen.error;
+
+    if (error == ANSILOVE_OK) {
+        error = alOutputScreen(canvas, canvas_height, atlas, &binary_screen, backgrounds, colors,
+                             ctx, options);
+    } else {
+        gdImageDestroy(canvas);
+    }
+
+    // free memory
+    alScreenFree(&binary_screen);
+
+    return error;
 }
@@ -11,10 +11,14 @@
 
 #include "icedraw.h"
 
-void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, bool createRetinaRep)
+int alIcedraw(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options)
 {
-    const unsigned char *font_data;
-    unsigned char *font_data_idf;
+    struct glyphAtlas atlas;
+
+    // the header, the font and the palette are always there
+    if (inputFileSize < 12 + 4096 + 48) {
+        return ANSILOVE_FORMAT_ERROR;
+    }
 
     // extract relevant part of the IDF header, 16-bit endian unsigned short
     int32_t x2 = (inputFileBuffer[9] << 8) + inputFileBuffer[8];
@@ -27,14 +31,9 @@ void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
     int32_t colors[16];
 
     // process IDF font
-    font_data_idf = (unsigned char *) malloc(sizeof(unsigned char)*4096);
-    if (font_data_idf == NULL) {
-        perror("Memory error");
-        exit (7);
+    if (!alBuildAtlas(&atlas, inputFileBuffer+(inputFileSize - 48 - 4096), 256, 8, 16)) {
+        return ANSILOVE_MEMORY_ERROR;
     }
-    memcpy(font_data_idf,inputFileBuffer+(inputFileSize - 48 - 4096),4096);
-
-    font_data=font_data_idf;
 
     // process IDF
     loop = 12;
@@ -44,6 +43,11 @@ void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
     unsigned char *idf_buffer, *temp;
     idf_buffer = malloc(sizeof(unsigned char));
 
+    if (idf_buffer == NULL) {
+        alFreeAtlas(&atlas);
+        return ANSILOVE_MEMORY_ERROR;
+    }
+
     int16_t idf_data, idf_data_length;
 
     while (loop < inputFileSize - 4096 - 48)
@@ -61,12 +65,13 @@ void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
             {
                 // reallocate IDF buffer memory
                 temp = realloc(idf_buffer, (i + 2) * sizeof(unsigned char));
-                if (idf_buffer != NULL) {
+                if (temp != NULL) {
                     idf_buffer = temp;
                 }
                 else {
-                    perror("Error allocating IDF buffer memory");
-                    exit (7);
+                    free(idf_buffer);
+                    alFreeAtlas(&atlas);
+                    return ANSILOVE_MEMORY_ERROR;
                 }
 
                 idf_buffer[i] = inputFileBuffer[loop + 4];
@@ -78,12 +83,13 @@ void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
         else {
             // reallocate IDF buffer memory
             temp = realloc(idf_buffer, (i + 2) * sizeof(unsigned char));
-            if (idf_buffer != NULL) {
+            if (temp != NULL) {
                 idf_buffer = temp;
             }
             else {
-                perror("Error allocating IDF buffer memory");
-                exit (8);
+                free(idf_buffer);
+                alFreeAtlas(&atlas);
+                return ANSILOVE_MEMORY_ERROR;
             }
 
             // normal character
@@ -94,13 +100,17 @@ void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
         loop += 2;
     }
 
-    // create IDF instance
-    canvas = gdImageCreate((x2 + 1) * 8, i / 2 / 80 * 16);
+    int32_t canvas_height = i / 2 / 80 * 16;
+
+    // create IDF instance, the canvas only holds the palette, the image is
+    // drawn and written a band at a time
+    canvas = canvas_height > 0 ? gdImageCreate((x2 + 1) * 8, 1) : NULL;
 
     // error output
     if (!canvas) {
-        perror("Can't allocate buffer image memory");
-        exit (9);
+        free(idf_buffer);
+        alFreeAtlas(&atlas);
+        return canvas_height > 0 ? ANSILOVE_MEMORY_ERROR : ANSILOVE_FORMAT_ERROR;
     }
     gdImageColorAllocate(canvas, 0, 0, 0);
 
@@ -113,9 +123,11 @@ void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
                                             (inputFileBuffer[index + 2] << 2 | inputFileBuffer[index + 2] >> 4));
     }
 
-    // render IDF
+    // process IDF screen
+    struct screen idf_screen;
     int32_t position_x = 0, position_y = 0;
-    int32_t character, attribute, foreground, background;
+
+    alScreenInit(&idf_screen, x2 + 1, alOutputRows((x2 + 1) * 8, 16));
 
     for (loop = 0; loop < i ; loop +=2)
     {
@@ -125,21 +137,25 @@ void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
             position_y++;
         }
 
-        character = idf_buffer[loop];
-        attribute = idf_buffer[loop+1];
-
-        background = (attribute & 240) >> 4;
-        foreground = attribute & 15;
-
-        drawchar(canvas, font_data, 8, 16, position_x, position_y, colors[background], colors[foreground], character);
+        alScreenPut(&idf_screen, position_x, position_y, idf_buffer[loop], idf_buffer[loop+1]);
 
         position_x++;
     }
 
-    // create output file
-    output(canvas, outputFile, retinaout, createRetinaRep);
+    // render IDF and create output file
+    int error = idf_screen.error;
+
+    if (error == ANSILOVE_OK) {
+        error = alOutputScreen(canvas, canvas_height, &atlas, &idf_screen, colors, colors,
+                             ctx, options);
+    } else {
+        gdImageDestroy(canvas);
+    }
 
     // free memory
-    free(font_data_idf);
+    alFreeAtlas(&atlas);
+    alScreenFree(&idf_screen);
     free(idf_buffer);
+
+    return error;
 }
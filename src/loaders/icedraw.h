@@ -14,7 +14,7 @@
 #ifndef icedraw_h
 #define icedraw_h
 
-void icedraw(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, bool createRetinaRep);
+int alIcedraw(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options);
 
 #endif
 
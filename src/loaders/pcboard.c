@@ -11,38 +11,50 @@
 
 #include "pcboard.h"
 
-void pcboard(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, char *font, int32_t bits, bool createRetinaRep)
+// colors are given as hex digits, 0-9 and A-F
+static int32_t pcbColor(int32_t digit)
+{
+    return (digit <= '9' ? digit - '0' : digit - 'A' + 10) & 15;
+}
+
+int alPcboard(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options)
 {
     // some type declarations
     struct fontStruct fontData;
     int32_t columns = 80;
-    int32_t loop, structIndex;
+    int32_t loop;
 
     // font selection
-    alSelectFont(&fontData, font);
+    alSelectFont(&fontData, options->font);
+    const struct glyphAtlas *atlas = alFontAtlas(&fontData, options->bits);
+
+    if (!atlas) {
+        return ANSILOVE_MEMORY_ERROR;
+    }
 
     // libgd image pointers
     gdImagePtr canvas;
 
     // process PCBoard
-    int32_t character, current_character, next_character;
-    int32_t background = 0, foreground = 7;
+    int32_t current_character, next_character, remaining;
+    int32_t background = '0', foreground = '7';
     int32_t position_x = 0, position_y = 0, position_x_max = 0, position_y_max = 0;
 
-    // PCB buffer structure array definition
-    struct pcbChar *pcboard_buffer, *temp;
+    // PCB screen, characters written later replace earlier ones
+    struct screen pcboard_screen;
 
-    // PCB buffer dynamic memory allocation
-    pcboard_buffer = malloc(sizeof(struct pcbChar));
+    alScreenInit(&pcboard_screen, columns, alOutputRows(columns * options->bits, fontData.height));
 
     // reset loop
     loop = 0;
-    structIndex = 0;
 
     while (loop < inputFileSize)
     {
+        // sequences cut off by the end of the file are not recognized
+        remaining = inputFileSize - loop;
+
         current_character = inputFileBuffer[loop];
-        next_character = inputFileBuffer[loop+1];
+        next_character = remaining > 1 ? inputFileBuffer[loop+1] : 0;
 
         if (position_x == 80)
         {
@@ -77,14 +89,14 @@ void pcboard(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
         }
 
         // PCB sequence
-        if (current_character == 64 && next_character == 88)
+        if (current_character == 64 && next_character == 88 && remaining > 3)
         {
             // set graphics rendition
             background = inputFileBuffer[loop+2];
             foreground = inputFileBuffer[loop+3];
             loop+=3;
         }
-        else if (current_character == 64 && next_character == 67 &&
+        else if (current_character == 64 && next_character == 67 && remaining > 3 &&
                  inputFileBuffer[loop+2] == 'L' && inputFileBuffer[loop+3] == 'S')
         {
             // erase display
@@ -96,7 +108,7 @@ void pcboard(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
 
             loop+=4;
         }
-        else if (current_character == 64 && next_character == 80 && inputFileBuffer[loop+2] == 'O'
+        else if (current_character == 64 && next_character == 80 && remaining > 6 && inputFileBuffer[loop+2] == 'O'
                  && inputFileBuffer[loop+3] == 'S' && inputFileBuffer[loop+4]== ':')
         {
             // cursor position
@@ -124,72 +136,57 @@ void pcboard(unsigned char *inputFileBuffer, int32_t inputFileSize, char *output
                 position_y_max = position_y;
             }
 
-            // reallocate structure array memory
-            temp = realloc(pcboard_buffer, (structIndex + 1) * sizeof(struct pcbChar));
-            pcboard_buffer = temp;
-
-            // write current character in pcbChar structure
-            pcboard_buffer[structIndex].position_x = position_x;
-            pcboard_buffer[structIndex].position_y = position_y;
-            pcboard_buffer[structIndex].background = background;
-            pcboard_buffer[structIndex].foreground = foreground;
-            pcboard_buffer[structIndex].current_character = current_character;
+            // write current character to the screen
+            alScreenPut(&pcboard_screen, position_x, position_y, current_character,
+                        pcbColor(foreground) | pcbColor(background) << 4);
 
             position_x++;
-            structIndex++;
         }
         loop++;
     }
     position_x_max++;
     position_y_max++;
 
-    // allocate buffer image memory
-    canvas = gdImageCreate(columns * bits, (position_y_max)*fontData.height);
+    // the canvas only holds the palette, the image is drawn and written a
+    // band at a time
+    canvas = pcboard_screen.error != ANSILOVE_OK ? NULL : gdImageCreate(columns * options->bits, 1);
 
-    // allocate black color and create background canvas
-    gdImageColorAllocate(canvas, 0, 0, 0);
-    gdImageFill(canvas, 0, 0, 0);
+    if (!canvas) {
+        int error = pcboard_screen.error != ANSILOVE_OK ? pcboard_screen.error : ANSILOVE_MEMORY_ERROR;
 
-    // allocate color palette
-    int32_t colors[71];
-
-    colors[48] = gdImageColorAllocate(canvas, 0, 0, 0);
-    colors[49] = gdImageColorAllocate(canvas, 0, 0, 170);
-    colors[50] = gdImageColorAllocate(canvas, 0, 170, 0);
-    colors[51] = gdImageColorAllocate(canvas, 0, 170, 170);
-    colors[52] = gdImageColorAllocate(canvas, 170, 0, 0);
-    colors[53] = gdImageColorAllocate(canvas, 170, 0, 170);
-    colors[54] = gdImageColorAllocate(canvas, 170, 85, 0);
-    colors[55] = gdImageColorAllocate(canvas, 170, 170, 170);
-    colors[56] = gdImageColorAllocate(canvas, 85, 85, 85);
-    colors[57] = gdImageColorAllocate(canvas, 85, 85, 255);
-    colors[65] = gdImageColorAllocate(canvas, 85, 255, 85);
-    colors[66] = gdImageColorAllocate(canvas, 85, 255, 255);
-    colors[67] = gdImageColorAllocate(canvas, 255, 85, 85);
-    colors[68] = gdImageColorAllocate(canvas, 255, 85, 255);
-    colors[69] = gdImageColorAllocate(canvas, 255, 255, 85);
-    colors[70] = gdImageColorAllocate(canvas, 255, 255, 255);
-
-    // the last value of loop tells us how many items are stored in there
-    int32_t pcbBufferItems = structIndex;
-
-    // render PCB
-    for (loop = 0; loop < pcbBufferItems; loop++)
-    {
-        // grab our chars out of the structure
-        position_x = pcboard_buffer[loop].position_x;
-        position_y = pcboard_buffer[loop].position_y;
-        background = pcboard_buffer[loop].background;
-        foreground = pcboard_buffer[loop].foreground;
-        character = pcboard_buffer[loop].current_character;
-
-        drawchar(canvas, fontData.font_data, bits, fontData.height,
-                   position_x, position_y, colors[background], colors[foreground], character);
+        alScreenFree(&pcboard_screen);
+        return error;
     }
 
-    // create output image
-    output(canvas, outputFile, retinaout, createRetinaRep);
+    // allocate black color, the background of the canvas
+    gdImageColorAllocate(canvas, 0, 0, 0);
+
+    // allocate color palette
+    int32_t colors[16];
+
+    colors[0] = gdImageColorAllocate(canvas, 0, 0, 0);
+    colors[1] = gdImageColorAllocate(canvas, 0, 0, 170);
+    colors[2] = gdImageColorAllocate(canvas, 0, 170, 0);
+    colors[3] = gdImageColorAllocate(canvas, 0, 170, 170);
+    colors[4] = gdImageColorAllocate(canvas, 170, 0, 0);
+    colors[5] = gdImageColorAllocate(canvas, 170, 0, 170);
+    colors[6] = gdImageColorAllocate(canvas, 170, 85, 0);
+    colors[7] = gdImageColorAllocate(canvas, 170, 170, 170);
+    colors[8] = gdImageColorAllocate(canvas, 85, 85, 85);
+    colors[9] = gdImageColorAllocate(canvas, 85, 85, 255);
+    colors[10] = gdImageColorAllocate(canvas, 85, 255, 85);
+    colors[11] = gdImageColorAllocate(canvas, 85, 255, 255);
+    colors[12] = gdImageColorAllocate(canvas, 255, 85, 85);
+    colors[13] = gdImageColorAllocate(canvas, 255, 85, 255);
+    colors[14] = gdImageColorAllocate(canvas, 255, 255, 85);
+    colors[15] = gdImageColorAllocate(canvas, 255, 255, 255);
+
+    // render PCB and create output image
+    int error = alOutputScreen(canvas, position_y_max * fontData.height, atlas, &pcboard_screen,
+                             colors, colors, ctx, options);
 
     // free memory
-    free(pcboard_buffer);
+    alScreenFree(&pcboard_screen);
+
+    return error;
 }
@@ -14,15 +14,6 @@
 #ifndef pcboard_h
 #define pcboard_h
 
-// Character structure
-struct pcbChar {
-    int32_t position_x;
-    int32_t position_y;
-    int32_t background;
-    int32_t foreground;
-    int32_t current_character;
-};
-
-void pcboard(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, char *font, int32_t bits, bool createRetinaRep);
+int alPcboard(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options);
 
 #endif
@@ -11,7 +11,7 @@
 
 #include "tundra.h"
 
-void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, char *font, int32_t bits, bool createRetinaRep)
+int alTundra(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options)
 {
     // some type declarations
     struct fontStruct fontData;
@@ -20,19 +20,29 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
     char tundra_header[8];
 
     // font selection
-    alSelectFont(&fontData, font);
+    alSelectFont(&fontData, options->font);
+    const struct glyphAtlas *atlas = alFontAtlas(&fontData, options->bits);
+
+    if (!atlas) {
+        return ANSILOVE_MEMORY_ERROR;
+    }
 
     // libgd image pointers
     gdImagePtr canvas;
 
     // extract tundra header
+    if (inputFileSize < 9)
+    {
+        return ANSILOVE_FORMAT_ERROR;
+    }
+
     tundra_version = inputFileBuffer[0];
     memcpy(&tundra_header,inputFileBuffer+1,8);
 
     // need to add check for "TUNDRA24" string in the header
     if (tundra_version != 24)
     {
-        fputs ("\nInput file is not a TUNDRA file.\n\n", stderr); exit (4);
+        return ANSILOVE_FORMAT_ERROR;
     }
 
     // read tundra file a first time to find the image size
@@ -53,6 +63,12 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character == 1)
         {
+            // a record cut off by the end of the file ends it
+            if (loop + 8 >= inputFileSize)
+            {
+                break;
+            }
+
             position_y =
                     (inputFileBuffer[loop + 1] << 24) + (inputFileBuffer[loop + 2] << 16) +
                             (inputFileBuffer[loop + 3] << 8) + inputFileBuffer[loop+4];
@@ -66,6 +82,12 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character == 2)
         {
+            // a record cut off by the end of the file ends it
+            if (loop + 5 >= inputFileSize)
+            {
+                break;
+            }
+
             character = inputFileBuffer[loop + 1];
 
             loop+=5;
@@ -73,6 +95,12 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character == 4)
         {
+            // a record cut off by the end of the file ends it
+            if (loop + 5 >= inputFileSize)
+            {
+                break;
+            }
+
             character = inputFileBuffer[loop + 1];
 
             loop+=5;
@@ -80,6 +108,12 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character == 6)
         {
+            // a record cut off by the end of the file ends it
+            if (loop + 9 >= inputFileSize)
+            {
+                break;
+            }
+
             character = inputFileBuffer[loop + 1];
 
             loop+=9;
@@ -95,11 +129,14 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
     position_y++;
 
     // allocate buffer image memory
-    canvas = gdImageCreateTrueColor(columns * bits , (position_y) * fontData.height);
+    if (position_y <= 0) {
+        return ANSILOVE_FORMAT_ERROR;
+    }
+
+    canvas = gdImageCreateTrueColor(columns * options->bits , (position_y) * fontData.height);
 
     if (!canvas) {
-        perror("Error, can't allocate buffer image memory");
-        exit (6);
+        return ANSILOVE_MEMORY_ERROR;
     }
 
     // process tundra
@@ -120,6 +157,12 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character == 1)
         {
+            // a record cut off by the end of the file ends it
+            if (loop + 8 >= inputFileSize)
+            {
+                break;
+            }
+
             position_y =
                     (inputFileBuffer[loop + 1] << 24) + (inputFileBuffer[loop + 2] << 16) +
                             (inputFileBuffer[loop + 3] << 8) + inputFileBuffer[loop + 4];
@@ -133,6 +176,12 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character == 2)
         {
+            // a record cut off by the end of the file ends it
+            if (loop + 5 >= inputFileSize)
+            {
+                break;
+            }
+
             foreground =
                     (inputFileBuffer[loop + 3] << 16) + (inputFileBuffer[loop + 4] << 8) +
                             inputFileBuffer[loop + 5];
@@ -144,6 +193,12 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character == 4)
         {
+            // a record cut off by the end of the file ends it
+            if (loop + 5 >= inputFileSize)
+            {
+                break;
+            }
+
             background = (inputFileBuffer[loop + 3] << 16) + (inputFileBuffer[loop + 4] << 8) +
                     inputFileBuffer[loop+5];
 
@@ -154,6 +209,12 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character==6)
         {
+            // a record cut off by the end of the file ends it
+            if (loop + 9 >= inputFileSize)
+            {
+                break;
+            }
+
             foreground =
                     (inputFileBuffer[loop + 3] << 16) + (inputFileBuffer[loop + 4] << 8) +
                             inputFileBuffer[loop+5];
@@ -169,8 +230,8 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
 
         if (character !=1 && character !=2 && character !=4 && character !=6)
         {
-            drawchar(canvas, fontData.font_data, bits, fontData.height,
-                    position_x, position_y, background, foreground, character);
+            alDrawChar(canvas, atlas, position_x, position_y,
+                    background, foreground, character);
 
             position_x++;
         }
@@ -179,6 +240,6 @@ void tundra(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputF
     }
 
     // create output image
-    output(canvas, outputFile, retinaout, createRetinaRep);
+    return alOutput(canvas, ctx, options);
 }
 
@@ -11,13 +11,13 @@
 
 #include "xbin.h"
 
-void xbin(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFile, char *retinaout, bool createRetinaRep)
+int alXbin(struct ansilove_ctx *ctx, const unsigned char *inputFileBuffer, int32_t inputFileSize, const struct ansilove_options *options)
 {
-    const unsigned char *font_data;
-    unsigned char *font_data_xbin = NULL;
+    const struct glyphAtlas *atlas;
+    struct glyphAtlas atlas_xbin = { NULL, 0, 0, 0 };
 
-    if (strncmp((char *)inputFileBuffer, "XBIN\x1a", 5) != 0) {
-        fputs("\nNot an XBin.\n\n", stderr); exit (4);
+    if (inputFileSize < 11 || strncmp((const char *)inputFileBuffer, "XBIN\x1a", 5) != 0) {
+        return ANSILOVE_FORMAT_ERROR;
     }
 
     int32_t xbin_width = (inputFileBuffer[ 6 ] << 8) + inputFileBuffer[ 5 ];
@@ -25,13 +25,23 @@ void xbin(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
     int32_t xbin_fontsize = inputFileBuffer[ 9 ];
     int32_t xbin_flags = inputFileBuffer[ 10 ];
 
+    // a screen without columns or rows has nothing to draw
+    if (xbin_width == 0 || xbin_height == 0) {
+        return ANSILOVE_FORMAT_ERROR;
+    }
+
     gdImagePtr canvas;
 
-    canvas = gdImageCreate(8 * xbin_width, xbin_fontsize * xbin_height);
+    // the canvas only holds the palette, the image is drawn and written a
+    // band at a time
+    if (xbin_fontsize * xbin_height <= 0) {
+        return ANSILOVE_FORMAT_ERROR;
+    }
+
+    canvas = gdImageCreate(8 * xbin_width, 1);
 
     if (!canvas) {
-        perror("Error, can't allocate buffer image memory");
-        exit (6);
+        return ANSILOVE_MEMORY_ERROR;
     }
 
     // allocate black color
@@ -45,6 +55,11 @@ void xbin(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
         int32_t loop;
         int32_t index;
 
+        if (offset + 48 > inputFileSize) {
+            gdImageDestroy(canvas);
+            return ANSILOVE_FORMAT_ERROR;
+        }
+
         for (loop = 0; loop < 16; loop++)
         {
             index = (loop * 3) + offset;
@@ -75,29 +90,42 @@ void xbin(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
         colors[15] = gdImageColorAllocate(canvas, 255, 255, 255);
     }
 
+    // in 512 character mode, foreground bit 3 selects the second half of the font
+    bool xbin_512 = (xbin_flags & 0x10) == 0x10;
+
     // font
     if( (xbin_flags & 2) == 2 ) {
-        int32_t numchars = ( xbin_flags & 0x10 ? 512 : 256 );
+        int32_t numchars = ( xbin_512 ? 512 : 256 );
 
-        // allocate memory to contain the XBin font
-        font_data_xbin = (unsigned char *) malloc(sizeof(unsigned char)*(xbin_fontsize * numchars));
-        if (font_data_xbin == NULL) {
-            perror("Memory error");
-            exit (5);
+        if (offset + xbin_fontsize * numchars > inputFileSize) {
+            gdImageDestroy(canvas);
+            return ANSILOVE_FORMAT_ERROR;
         }
-        memcpy(font_data_xbin,inputFileBuffer+offset,(xbin_fontsize * numchars));
 
-        font_data=font_data_xbin;
+        atlas = alBuildAtlas(&atlas_xbin, inputFileBuffer+offset, numchars, 8, xbin_fontsize) ?
+            &atlas_xbin : NULL;
 
         offset += ( xbin_fontsize * numchars );
     }
     else {
         // using default 80x25 font
-        font_data = font_pc_80x25;
+        struct fontStruct fontData;
+
+        alSelectFont(&fontData, "80x25");
+        atlas = alFontAtlas(&fontData, 8);
+        xbin_512 = false;
+    }
+
+    if (!atlas) {
+        gdImageDestroy(canvas);
+        return ANSILOVE_MEMORY_ERROR;
     }
 
+    struct screen xbin_screen;
     int32_t position_x = 0, position_y = 0;
-    int32_t character, attribute, foreground, background;
+    int32_t character, attribute;
+
+    alScreenInit(&xbin_screen, xbin_width, alOutputRows(8 * xbin_width, xbin_fontsize));
 
     // read compressed xbin
     if( (xbin_flags & 4) == 4) {
@@ -111,6 +139,24 @@ void xbin(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
 
             offset++;
             while( counter-- ) {
+                // a run cut off by the end of the file ends it
+                int32_t needed = 2;
+
+                if( ctype == 0x40 ) {
+                    needed = ( character == -1 ) + 1;
+                }
+                else if ( ctype == 0x80 ) {
+                    needed = ( attribute == -1 ) + 1;
+                }
+                else if ( ctype == 0xC0 ) {
+                    needed = ( character == -1 ) + ( attribute == -1 );
+                }
+
+                if( offset + needed > inputFileSize ) {
+                    offset = inputFileSize;
+                    break;
+                }
+
                 // none
                 if( ctype == 0 ) {
                     character = inputFileBuffer[ offset ];
@@ -147,10 +193,12 @@ void xbin(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
                     }
                 }
 
-                background = (attribute & 240) >> 4;
-                foreground = attribute & 15;
-
-                drawchar(canvas, font_data, 8, 16, position_x, position_y, colors[background], colors[foreground], character);
+                if (xbin_512) {
+                    alScreenPut(&xbin_screen, position_x, position_y,
+                                character | (attribute & 8) << 5, attribute & ~8);
+                } else {
+                    alScreenPut(&xbin_screen, position_x, position_y, character, attribute);
+                }
 
                 position_x++;
 
@@ -164,7 +212,7 @@ void xbin(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
     }
     // read uncompressed xbin
     else {
-        while(offset < inputFileSize && position_y != xbin_height )
+        while(offset + 1 < inputFileSize && position_y != xbin_height )
         {
             if (position_x == xbin_width)
             {
@@ -175,19 +223,31 @@ void xbin(unsigned char *inputFileBuffer, int32_t inputFileSize, char *outputFil
             character = inputFileBuffer[offset];
             attribute = inputFileBuffer[offset+1];
 
-            background = (attribute & 240) >> 4;
-            foreground = attribute & 15;
-
-            drawchar(canvas, font_data, 8, xbin_fontsize, position_x, position_y, colors[background], colors[foreground], character);
+            if (xbin_512) {
+                alScreenPut(&xbin_screen, position_x, position_y,
+                            character | (attribute & 8) << 5, attribute & ~8);
+            } else {
+                alScreenPut(&xbin_screen, position_x, position_y, character, attribute);
+            }
 
             position_x++;
             offset+=2;
         }
     }
 
-    // create output file
-    output(canvas, outputFile, retinaout, createRetinaRep);
+    // render XBin and create output file
+    int error = xbin_screen.error;
+
+    if (error == ANSILOVE_OK) {
+        error = alOutputScreen(canvas, xbin_fontsize * xbin_height, atlas, &xbin_screen, colors, colors,
+                             ctx, options);
+    } else {
+        gdImageDestroy(canvas);
+    }
 
     // nuke garbage
-    free(font_data_xbin);
+    alFreeAtlas(&atlas_xbin);
+    alScreenFree(&xbin_screen);
+
+    return error;
 }
@@ -11,9 +11,11 @@
 
 #define _XOPEN_SOURCE 700
 #include <sys/stat.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdbool.h>
 #include <getopt.h>
 #include <unistd.h>
@@ -28,24 +30,168 @@
 #endif
 
 #include "config.h"
-#include "strtolower.h"
 #include "ansilove.h"
 #include "sauce.h"
+#include "sauceindex.h"
+#include "cache.h"
+#include "server.h"
 
-#include "loaders/ansi.h"
-#include "loaders/artworx.h"
-#include "loaders/binary.h"
-#include "loaders/icedraw.h"
-#include "loaders/pcboard.h"
-#include "loaders/tundra.h"
-#include "loaders/xbin.h"
+// options shared by all input files
+struct options {
+    bool justDisplaySAUCE;
+    bool verbose;
+    char *output;
+    char *outputDir;
+    // every input is of the type given instead of its extension's
+    bool typeGiven;
+    int32_t format;
+    bool toStdout;
+    struct ansilove_options render;
+    // paths are name templates here, see scalePath()
+    struct ansilove_output scales[ANSILOVE_OUTPUTS_MAX - 1];
+    int32_t scaleCount;
+    struct renderCache *cache;
+};
+
+// upper limit for the number of files converted at once
+#define JOBS_MAX 256
+
+// types -T takes, the extensions of files of each type
+static const char *const typeNames[] = {
+    "ans", "bin", "adf", "idf", "tnd", "xb", "pcb", "diz", "asc", "nfo", "txt"
+};
+
+// a file of a parallel batch, its messages are kept until every file
+// before it has been printed
+struct job {
+    char *input;
+    off_t size;
+    char *messages;
+    size_t messagesSize;
+    int status;
+    bool done;
+};
+
+// a parallel batch, workers take the largest remaining file next
+struct batch {
+    struct options *opts;
+    struct job *jobs;
+    struct job **queue;
+    int32_t count;
+    int32_t next;
+    int32_t printed;
+    int status;
+    pthread_mutex_t lock;
+};
 
 // prototypes
+int convert(char *input, struct options *opts, FILE *messages);
+int convertBatch(char **inputs, int32_t count, struct options *opts, int32_t jobs);
+void *batchWorker(void *arg);
+int compareJobs(const void *a, const void *b);
+unsigned char *readInput(int fd, size_t *length);
+bool writeOutput(int fd, const struct ansilove_output *output);
+bool parseScale(char *arg, struct ansilove_output *scale);
+char *scalePath(const struct ansilove_output *scale, const char *outputName);
+const char *formatExtension(int32_t format);
+void showBanner(void);
 void showHelp(void);
 void listExamples(void);
 void versionInfo(void);
 void synopsis(void);
 
+// reads factor[:template] or 1/divisor[:template], templates may only
+// use %s for the output name and %% for a percent sign
+bool parseScale(char *arg, struct ansilove_output *scale) {
+    const char *errstr;
+    char *pattern = strchr(arg, ':');
+    char *number = arg;
+
+    if (pattern) {
+        *pattern++ = '\0';
+
+        for (const char *c = pattern; *c; c++) {
+            if (*c == '%' && c[1] != 's' && c[1] != '%') {
+                return false;
+            }
+            if (*c == '%') {
+                c++;
+            }
+        }
+    }
+
+    scale->factor = 1;
+    scale->divisor = 1;
+    scale->format = ANSILOVE_PNG;
+    scale->path = pattern;
+
+    if (!strncmp(number, "1/", 2)) {
+        scale->divisor = strtonum(number + 2, 2, 64, &errstr);
+    } else {
+        scale->factor = strtonum(number, 1, 16, &errstr);
+    }
+
+    return errstr == NULL;
+}
+
+// the extension of output files in a format
+const char *formatExtension(int32_t format) {
+    switch (format) {
+    case ANSILOVE_RGBA:
+        return ".rgba";
+    case ANSILOVE_RGB:
+        return ".rgb";
+    case ANSILOVE_INDEXED:
+        return ".idx";
+    default:
+        return ".png";
+    }
+}
+
+// the output file of a scale, made from its template, or named like
+// file@3x.png or file@1-4x.png after the output name without one
+char *scalePath(const struct ansilove_output *scale, const char *outputName) {
+    char *path;
+    size_t pathSize;
+    FILE *out = open_memstream(&path, &pathSize);
+
+    if (out == NULL) {
+        perror("Memory error");
+        exit(2);
+    }
+
+    if (!scale->path) {
+        if (scale->divisor > 1) {
+            fprintf(out, "%s@1-%dx%s", outputName, scale->divisor,
+                    formatExtension(scale->format));
+        } else {
+            fprintf(out, "%s@%dx%s", outputName, scale->factor,
+                    formatExtension(scale->format));
+        }
+    } else {
+        for (const char *c = scale->path; *c; c++) {
+            if (c[0] == '%' && c[1] == 's') {
+                fputs(outputName, out);
+                c++;
+            } else if (c[0] == '%' && c[1] == '%') {
+                fputc('%', out);
+                c++;
+            } else {
+                fputc(*c, out);
+            }
+        }
+    }
+
+    fclose(out);
+
+    return path;
+}
+
+void showBanner(void) {
+    printf("AnsiLove/C %s - ANSI / ASCII art to PNG converter\n"\
+           "Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.\n", VERSION);
+}
+
 void showHelp(void) {
     printf("\nSUPPORTED FILE TYPES:\n"
            "  ANS  BIN  ADF  IDF  XB  PCB  TND  ASC  NFO  DIZ\n"
@@ -80,6 +226,17 @@ void listExamples(void) {
            "  ansilove -m transparent file.ans (render with transparent background)\n"
            "  ansilove -f amiga file.txt (custom font)\n"
            "  ansilove -f 80x50 -b 9 -c 320 -i file.bin (custom font, bits, columns, icecolors)\n"
+           "  ansilove -t 1 file.ans (draw with a single thread)\n"
+           "  ansilove -d dir *.ans (convert many files, output goes to dir)\n"
+           "  ansilove -j 8 -d dir *.bin (convert 8 files at a time)\n"
+           "  ansilove -C cache -d dir *.ans (only render files that changed)\n"
+           "  unzip -p art.zip file.bin | ansilove -T bin - > file.png (pipeline)\n"
+           "  ansilove -S 3 -S 1/4:thumbs/%%s.png file.ans (adds @3x and thumbnail files)\n"
+           "  ansilove -z 1 file.bin (fastest compression)\n"
+           "  ansilove -F rgba file.ans (raw pixels for a texture, in file.ans.rgba)\n"
+           "  ansilove -z 9 -p adaptive file.xb (smallest output)\n"
+           "  ansilove -x jsonl archive > index.jsonl (index SAUCE records of a tree)\n"
+           "  ansilove -D /tmp/ansilove.sock -j 4 (serve render jobs, 4 at a time)\n"
            "\n");
 }
 
@@ -94,74 +251,106 @@ void versionInfo(void) {
 // following the IEEE Std 1003.1 for utility conventions
 void synopsis(void) {
     printf("\nSYNOPSIS:\n"
-           "  ansilove [options] file\n"
+           "  ansilove [options] file ...\n"
+           "  ansilove [options] -T type [-o file] -\n"
+           "  ansilove [options] -D socket\n"
            "  ansilove -e | -h | -v\n\n"
            "OPTIONS:\n"
            "  -b bits     set to 9 to render 9th column of block characters (default: 8)\n"
            "  -c columns  adjust number of columns for BIN files (default: 160)\n"
+           "  -C dir      copy images rendered before from a cache in dir, and\n"
+           "              keep new ones there\n"
+           "  -d dir      specify output directory\n"
+           "  -D socket   serve render jobs on a Unix socket, or on stdin and\n"
+           "              stdout for -, -j sets how many are served at once\n"
            "  -e          print a list of examples\n"
            "  -f font     select font (default: 80x25)\n"
+           "  -F format   write images as png, or as raw rgba, rgb or indexed\n"
+           "              frames with a 16 byte header (default: png)\n"
            "  -h          show help\n"
            "  -i          enable iCE colors\n"
+           "  -j jobs     set number of files converted at once (default: 1)\n"
            "  -m mode     set rendering mode for ANS files:\n"
            "                ced            black on gray, with 78 columns\n"
            "                transparent    render with transparent background\n"
            "                workbench      use Amiga Workbench palette\n"
-           "  -o file     specify output filename/path\n"
-           "  -r          creates additional Retina @2x output file\n"
+           "  -o file     specify output filename/path, - for stdout\n"
+           "  -p filter   set PNG row filter: none, sub, up or adaptive (default: none)\n"
+           "  -r          creates additional Retina @2x output file, same as -S 2\n"
            "  -s          show SAUCE record without generating output\n"
+           "  -S scale    also write the image scaled, scale is a factor up to 16\n"
+           "              or 1/divisor up to 1/64, optionally followed by\n"
+           "              :template, %%s in it stands for the output name\n"
+           "              (default: %%s@2x.png for 2, %%s@1-4x.png for 1/4)\n"
+           "  -t threads  set number of drawing threads (default: number of CPUs)\n"
+           "  -T type     read every file as this type, e.g. bin, whatever its name\n"
            "  -v          show version information\n"
+           "  -V          show the processor time each output file took\n"
+           "  -x format   print SAUCE records of files and directories as jsonl or csv\n"
+           "  -z level    set PNG compression level from 0 to 9 (default: 6)\n"
            "\n");
 }
 
 int main(int argc, char *argv[]) {
-    printf("AnsiLove/C %s - ANSI / ASCII art to PNG converter\n"\
-           "Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.\n", VERSION);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
 
-    // SAUCE record related bool types
-    bool justDisplaySAUCE = false;
-    bool fileHasSAUCE = false;
-
-    // retina output bool type
-    bool createRetinaRep = false;
+    struct options opts = {
+        .justDisplaySAUCE = false,
+        .verbose = false,
+        .output = NULL,
+        .outputDir = NULL,
+        .typeGiven = false,
+        .format = ANSILOVE_PNG,
+        .toStdout = false,
+        .scaleCount = 0,
+        .cache = NULL
+    };
+    struct renderCache cache;
+    struct ansilove_ctx defaults;
+    char *mode = NULL;
 
-    // iCE colors bool type
-    bool icecolors = false;
+    // default to 8 bits, 160 columns, zlib's level and unfiltered rows
+    // if these options are not specified
+    ansilove_init(&defaults, &opts.render);
 
-    // analyze options and do what has to be done
-    bool fileIsBinary = false;
-    bool fileIsANSi = false;
-    bool fileIsPCBoard = false;
-    bool fileIsTundra = false;
+    // default to one drawing thread per CPU if threads option is not specified
+    opts.render.threads = cpus < 1 ? 1 : cpus > DRAW_THREADS_MAX ? DRAW_THREADS_MAX : cpus;
 
     int getoptFlag;
-    char *mode = NULL;
-    char *font = NULL;
+    int status = EXIT_SUCCESS;
 
-    char *input = NULL, *output = NULL;
-    char *retinaout = NULL;
+    // default to one file at a time if jobs option is not specified
+    int32_t jobs = 1;
+    bool threadsGiven = false;
+    bool jobsGiven = false;
 
-    char *outputFile;
+    // no SAUCE index unless the index option is specified
+    int32_t indexFormat = 0;
 
-    const char *errstr;
+    // no render server unless the server option is specified
+    char *serverPath = NULL;
 
-    // default to 8 if bits option is not specified
-    int32_t bits = 8;
+    // every file is rendered unless the cache option is specified
+    char *cacheDir = NULL;
 
-    // default to 160 if columns option is not specified
-    int32_t columns = 160;
+    // files are typed by their extension unless the type option is specified
+    char typeName[16];
+    size_t typeIndex, typeCount = sizeof(typeNames) / sizeof(typeNames[0]);
+
+    const char *errstr;
 
-    if (pledge("stdio cpath rpath wpath", NULL) == -1) {
+    if (pledge("stdio cpath rpath wpath unix", NULL) == -1) {
         err(EXIT_FAILURE, "pledge");
     }
 
-    while ((getoptFlag = getopt(argc, argv, "b:c:ef:him:o:rsv")) != -1) {
+    while ((getoptFlag = getopt(argc, argv, "b:c:C:d:D:ef:F:hij:m:o:p:rsS:t:T:vVx:z:")) != -1) {
         switch(getoptFlag) {
         case 'b':
             // convert numeric command line flags to integer values
-            bits = strtonum(optarg, 8, 9, &errstr);
+            opts.render.bits = strtonum(optarg, 8, 9, &errstr);
 
             if (errstr) {
+                showBanner();
                 printf("\nInvalid value for bits.\n\n");
                 return EXIT_FAILURE;
             }
@@ -169,47 +358,227 @@ int main(int argc, char *argv[]) {
             break;
         case 'c':
             // convert numeric command line flags to integer values
-            columns = strtonum(optarg, 1, 8192, &errstr);
+            opts.render.columns = strtonum(optarg, 1, 8192, &errstr);
 
             if (errstr) {
+                showBanner();
                 printf("\nInvalid value for columns.\n\n");
                 return EXIT_FAILURE;
             }
 
+            break;
+        case 'C':
+            cacheDir = optarg;
+            break;
+        case 'd':
+            opts.outputDir = optarg;
+            break;
+        case 'D':
+            serverPath = optarg;
             break;
         case 'e':
+            showBanner();
             listExamples();
             return EXIT_SUCCESS;
         case 'f':
-            font = optarg;
+            opts.render.font = optarg;
+            break;
+        case 'F':
+            if (!strcmp(optarg, "png")) {
+                opts.format = ANSILOVE_PNG;
+            } else if (!strcmp(optarg, "rgba")) {
+                opts.format = ANSILOVE_RGBA;
+            } else if (!strcmp(optarg, "rgb")) {
+                opts.format = ANSILOVE_RGB;
+            } else if (!strcmp(optarg, "indexed")) {
+                opts.format = ANSILOVE_INDEXED;
+            } else {
+                showBanner();
+                printf("\nInvalid value for output format.\n\n");
+                return EXIT_FAILURE;
+            }
+
             break;
         case 'h':
+            showBanner();
             showHelp();
             return EXIT_SUCCESS;
         case 'i':
-            icecolors = true;
+            opts.render.icecolors = true;
+            break;
+        case 'j':
+            // convert numeric command line flags to integer values
+            jobs = strtonum(optarg, 1, JOBS_MAX, &errstr);
+
+            if (errstr) {
+                showBanner();
+                printf("\nInvalid value for jobs.\n\n");
+                return EXIT_FAILURE;
+            }
+
+            jobsGiven = true;
+
             break;
         case 'm':
             mode = optarg;
             break;
         case 'o':
-            output = optarg;
+            opts.output = optarg;
+            break;
+        case 'p':
+            if (!strcmp(optarg, "none")) {
+                opts.render.filters = ANSILOVE_FILTER_NONE;
+            } else if (!strcmp(optarg, "sub")) {
+                opts.render.filters = ANSILOVE_FILTER_SUB;
+            } else if (!strcmp(optarg, "up")) {
+                opts.render.filters = ANSILOVE_FILTER_UP;
+            } else if (!strcmp(optarg, "adaptive")) {
+                opts.render.filters = ANSILOVE_FILTER_ADAPTIVE;
+            } else {
+                showBanner();
+                printf("\nInvalid value for filter.\n\n");
+                return EXIT_FAILURE;
+            }
+
             break;
         case 'r':
-            createRetinaRep = true;
+        case 'S':
+            if (opts.scaleCount == ANSILOVE_OUTPUTS_MAX - 1) {
+                showBanner();
+                printf("\nToo many scales, at most %d.\n\n", ANSILOVE_OUTPUTS_MAX - 1);
+                return EXIT_FAILURE;
+            }
+
+            // -r is short for -S 2, named file@2x.png
+            if (getoptFlag == 'r') {
+                opts.scales[opts.scaleCount].factor = 2;
+                opts.scales[opts.scaleCount].divisor = 1;
+                opts.scales[opts.scaleCount].format = ANSILOVE_PNG;
+                opts.scales[opts.scaleCount].path = NULL;
+            } else if (!parseScale(optarg, &opts.scales[opts.scaleCount])) {
+                showBanner();
+                printf("\nInvalid value for scale.\n\n");
+                return EXIT_FAILURE;
+            }
+
+            opts.scaleCount++;
             break;
         case 's':
-            justDisplaySAUCE = true;
+            opts.justDisplaySAUCE = true;
+            break;
+        case 't':
+            // convert numeric command line flags to integer values
+            opts.render.threads = strtonum(optarg, 1, DRAW_THREADS_MAX, &errstr);
+
+            if (errstr) {
+                showBanner();
+                printf("\nInvalid value for threads.\n\n");
+                return EXIT_FAILURE;
+            }
+
+            threadsGiven = true;
+
+            break;
+        case 'T':
+            for (typeIndex = 0; typeIndex < typeCount; typeIndex++) {
+                if (!strcasecmp(optarg, typeNames[typeIndex])) {
+                    break;
+                }
+            }
+
+            if (typeIndex == typeCount) {
+                showBanner();
+                printf("\nInvalid value for type.\n\n");
+                return EXIT_FAILURE;
+            }
+
+            // named like a file of that type, the extension is all it takes
+            snprintf(typeName, sizeof(typeName), ".%s", optarg);
+            opts.typeGiven = true;
             break;
         case 'v':
+            showBanner();
             versionInfo();
             return EXIT_SUCCESS;
+        case 'V':
+            opts.verbose = true;
+            break;
+        case 'x':
+            if (!strcmp(optarg, "jsonl")) {
+                indexFormat = INDEX_JSONL;
+            } else if (!strcmp(optarg, "csv")) {
+                indexFormat = INDEX_CSV;
+            } else {
+                showBanner();
+                printf("\nInvalid value for format.\n\n");
+                return EXIT_FAILURE;
+            }
+
+            break;
+        case 'z':
+            // convert numeric command line flags to integer values
+            opts.render.level = strtonum(optarg, 0, 9, &errstr);
+
+            if (errstr) {
+                showBanner();
+                printf("\nInvalid value for level.\n\n");
+                return EXIT_FAILURE;
+            }
+
+            break;
         }
     }
 
-    if (optind < argc) {
-        input = argv[optind];
-    } else {
+    // default to the normal mode if mode option is not specified or unknown
+    if (mode && !strcmp(mode, "ced")) {
+        opts.render.mode = ANSILOVE_MODE_CED;
+    } else if (mode && !strcmp(mode, "transparent")) {
+        opts.render.mode = ANSILOVE_MODE_TRANSPARENT;
+    } else if (mode && !strcmp(mode, "workbench")) {
+        opts.render.mode = ANSILOVE_MODE_WORKBENCH;
+    }
+
+    // every input, and every job served, is of the type given
+    if (opts.typeGiven) {
+        ansilove_filetype(&opts.render, typeName);
+    }
+
+    // default to 80x25 font if font option is not specified
+    if (!opts.render.font) {
+        opts.render.font = "80x25";
+    }
+
+    // only the server listens on sockets
+    if (!serverPath && pledge("stdio cpath rpath wpath", NULL) == -1) {
+        err(EXIT_FAILURE, "pledge");
+    }
+
+    // the image goes to stdout when asked to, or when a single input is
+    // read from stdin without an output file
+    opts.toStdout = !indexFormat && !serverPath && !opts.justDisplaySAUCE &&
+        (opts.output ? !strcmp(opts.output, "-") :
+         argc - optind == 1 && !strcmp(argv[optind], "-"));
+
+    // the index is meant for other programs, so stdout only carries
+    // records, and served on stdin, it carries responses, as it carries
+    // the image when it is written there
+    if (!indexFormat && !(serverPath && !strcmp(serverPath, "-")) && !opts.toStdout) {
+        showBanner();
+    }
+
+    if (serverPath) {
+        // share the CPUs between the jobs being served, one per CPU by default
+        if (!jobsGiven) {
+            jobs = opts.render.threads;
+        }
+        if (!threadsGiven) {
+            opts.render.threads = opts.render.threads / jobs > 1 ? opts.render.threads / jobs : 1;
+        }
+
+        return renderServer(serverPath, &opts.render, jobs, opts.render.threads);
+    }
+
+    if (optind >= argc) {
         synopsis();
         return EXIT_SUCCESS;
     }
@@ -217,181 +586,486 @@ int main(int argc, char *argv[]) {
     argc -= optind;
     argv += optind;
 
-    // let's check the file for a valid SAUCE record
-    sauce *record = sauceReadFileName(input);
+    if (indexFormat) {
+        // reading file tails is cheap, keep every CPU busy by default
+        return sauceIndex(argv, argc, jobsGiven ? jobs : opts.render.threads, indexFormat);
+    }
 
-    // record == NULL also means there is no file, we can stop here
-    if (record == NULL) {
-        printf("\nFile %s not found.\n\n", input);
+    // an output file name only makes sense for a single input file
+    if (opts.output && (argc > 1 || opts.outputDir)) {
+        printf("\nOption -o can't be used with several files or -d.\n\n");
+        return EXIT_FAILURE;
+    }
+
+    // stdin is read once, into a single image
+    for (int32_t i = 0; i < argc; i++) {
+        if (!strcmp(argv[i], "-") && argc > 1) {
+            printf("\nInput - can't be used with several files.\n\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (opts.toStdout && opts.scaleCount > 0) {
+        fputs("\nScaled images can't be written to standard output.\n\n", stderr);
         return EXIT_FAILURE;
+    }
+
+    // only files are cached
+    if (cacheDir && !opts.justDisplaySAUCE && !opts.toStdout) {
+        if (!cacheOpen(&cache, cacheDir)) {
+            fprintf(stderr, "\nCan't use cache directory %s: %s\n\n", cacheDir, strerror(errno));
+            return EXIT_FAILURE;
+        }
+
+        opts.cache = &cache;
+    }
+
+    if (jobs > argc) {
+        jobs = argc;
+    }
+
+    if (jobs > 1) {
+        // share the CPUs between the files being converted
+        if (!threadsGiven) {
+            opts.render.threads = opts.render.threads / jobs > 1 ? opts.render.threads / jobs : 1;
+        }
+
+        status = convertBatch(argv, argc, &opts, jobs);
     } else {
-        // if we find a SAUCE record, update bool flag
-        if (!strcmp(record->ID, SAUCE_ID)) {
-            fileHasSAUCE = true;
+        // fonts are only set up once, the atlas cache keeps them around
+        // for the following files
+        for (int32_t i = 0; i < argc; i++) {
+            if (convert(argv[i], &opts, opts.toStdout ? stderr : stdout) != EXIT_SUCCESS) {
+                status = EXIT_FAILURE;
+            }
         }
     }
 
-    if (!justDisplaySAUCE) {
-        // create output file name if output is not specified
-        char *outputName;
+    if (opts.cache) {
+        printf("\nCache: %d hits, %d misses\n\n", cache.hits, cache.misses);
+    }
 
-        if (!output) {
-            outputName = input;
-            // appending ".png" extension to output file name
-            int outputLen = strlen(outputName) + 5;
-            outputFile = malloc(outputLen);
-            snprintf(outputFile, outputLen, "%s%s", outputName, ".png");
+    return status;
+}
+
+// largest files first, so small ones fill the gaps at the end
+int compareJobs(const void *a, const void *b) {
+    const struct job *jobA = *(struct job * const *)a;
+    const struct job *jobB = *(struct job * const *)b;
+
+    if (jobA->size != jobB->size) {
+        return jobA->size < jobB->size ? 1 : -1;
+    }
+
+    return jobA < jobB ? -1 : jobA > jobB;
+}
+
+// reads everything up to the end of fd, NULL with errno set on failure
+unsigned char *readInput(int fd, size_t *length) {
+    size_t size = 65536, done = 0;
+    unsigned char *buffer = malloc(size), *grown;
+    ssize_t count;
+
+    while (buffer != NULL) {
+        if (done == size) {
+            grown = realloc(buffer, size * 2);
+
+            if (grown == NULL) {
+                free(buffer);
+                errno = ENOMEM;
+                return NULL;
+            }
+
+            buffer = grown;
+            size *= 2;
         }
-        else {
-            outputName = output;
-            outputFile = outputName;
+
+        count = read(fd, buffer + done, size - done);
+
+        if (count == 0) {
+            *length = done;
+            return buffer;
         }
 
-        if (createRetinaRep) {
-            int retinaLen = strlen(outputName) + 8;
-            retinaout = malloc(retinaLen);
-            snprintf(retinaout, retinaLen, "%s%s", outputName, "@2x.png");
+        if (count == -1 && errno != EINTR) {
+            free(buffer);
+            return NULL;
         }
 
-        // default to empty string if mode option is not specified
-        if (!mode) {
-            mode = "";
+        done += count > 0 ? count : 0;
+    }
+
+    errno = ENOMEM;
+    return NULL;
+}
+
+// writes an image kept in memory to fd, in a single write unless fd
+// takes less at once
+bool writeOutput(int fd, const struct ansilove_output *output) {
+    const unsigned char *next = output->data;
+    size_t length = output->length;
+    ssize_t count;
+
+    while (length > 0) {
+        count = write(fd, next, length);
+
+        if (count == -1 && errno == EINTR) {
+            continue;
         }
 
-        // default to 80x25 font if font option is not specified
-        if (!font) {
-            font = "80x25";
+        if (count <= 0) {
+            return false;
         }
 
-        // display name of input and output files
-        printf("\nInput File: %s\n", input);
-        printf("Output File: %s\n", outputFile);
+        next += count;
+        length -= count;
+    }
+
+    return true;
+}
+
+// converts files until none are left, then prints every finished file
+// whose predecessors are printed already
+void *batchWorker(void *arg) {
+    struct batch *batch = arg;
+    struct job *job;
+
+    for (;;) {
+        pthread_mutex_lock(&batch->lock);
+        job = batch->next < batch->count ? batch->queue[batch->next++] : NULL;
+        pthread_mutex_unlock(&batch->lock);
+
+        if (job == NULL) {
+            return NULL;
+        }
 
-        if (createRetinaRep) {
-            printf("Retina Output File: %s\n", retinaout);
+        FILE *messages = open_memstream(&job->messages, &job->messagesSize);
+        if (messages == NULL) {
+            perror("Memory error");
+            exit(2);
         }
 
-        // get file extension
-        char *fext = strrchr(input, '.');
-        fext = fext ? strtolower(strdup(fext)) : "";
+        job->status = convert(job->input, batch->opts, messages);
+        fclose(messages);
+
+        pthread_mutex_lock(&batch->lock);
+        job->done = true;
+
+        while (batch->printed < batch->count && batch->jobs[batch->printed].done) {
+            job = &batch->jobs[batch->printed++];
+
+            fwrite(job->messages, 1, job->messagesSize, stdout);
+            free(job->messages);
 
-        // load input file
-        FILE *input_file = fopen(input, "r");
-        if (input_file == NULL) {
-            perror("File error");
-            return 1;
+            if (job->status != EXIT_SUCCESS) {
+                batch->status = EXIT_FAILURE;
+            }
         }
 
-        // get the file size (bytes)
-        struct stat input_file_stat;
+        fflush(stdout);
+        pthread_mutex_unlock(&batch->lock);
+    }
+}
+
+// converts files on several threads, messages come out in input order
+int convertBatch(char **inputs, int32_t count, struct options *opts, int32_t jobs) {
+    pthread_t workers[JOBS_MAX];
+    int32_t started = 0, i;
+    struct stat input_stat;
+    struct batch batch;
 
-        if (fstat(fileno(input_file), &input_file_stat)) {
-            perror("Can't stat file");
-            return 1;
+    batch.opts = opts;
+    batch.count = count;
+    batch.next = 0;
+    batch.printed = 0;
+    batch.status = EXIT_SUCCESS;
+    batch.jobs = calloc(count, sizeof(struct job));
+    batch.queue = malloc(count * sizeof(struct job *));
+
+    if (batch.jobs == NULL || batch.queue == NULL) {
+        perror("Memory error");
+        return 2;
+    }
+
+    for (i = 0; i < count; i++) {
+        batch.jobs[i].input = inputs[i];
+        batch.jobs[i].size = stat(inputs[i], &input_stat) ? 0 : input_stat.st_size;
+        batch.queue[i] = &batch.jobs[i];
+    }
+
+    qsort(batch.queue, count, sizeof(struct job *), compareJobs);
+
+    pthread_mutex_init(&batch.lock, NULL);
+
+    // the main thread converts files as well
+    for (i = 1; i < jobs; i++) {
+        if (pthread_create(&workers[started], NULL, batchWorker, &batch) == 0) {
+            started++;
         }
-        size_t inputFileSize=input_file_stat.st_size;
+    }
 
-        // next up is loading our file into a dynamically allocated memory buffer
-        unsigned char *inputFileBuffer;
+    batchWorker(&batch);
+
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&batch.lock);
+    free(batch.queue);
+    free(batch.jobs);
+
+    return batch.status;
+}
+
+// converts a single file, or just displays its SAUCE record
+int convert(char *input, struct options *opts, FILE *messages) {
+    // SAUCE record related bool types
+    bool fileHasSAUCE = false;
 
-        // allocate memory to contain the whole file
-        inputFileBuffer = (unsigned char *) malloc(sizeof(unsigned char)*inputFileSize + 1);
-        if (inputFileBuffer == NULL) {
+    struct ansilove_ctx ctx;
+    struct ansilove_options options;
+    char *outputPath = NULL;
+    int status = EXIT_SUCCESS;
+    uint64_t keys[ANSILOVE_OUTPUTS_MAX];
+    bool cached = false;
+    unsigned char *stdinBuffer = NULL;
+
+    ansilove_init(&ctx, &options);
+    options = opts->render;
+
+    // load input file, or all there is on stdin for -
+    if (!strcmp(input, "-")) {
+        stdinBuffer = readInput(STDIN_FILENO, &ctx.length);
+
+        if (stdinBuffer == NULL) {
+            fprintf(messages, "\nCan't read standard input: %s\n\n", strerror(errno));
+            return EXIT_FAILURE;
+        }
+
+        ctx.buffer = stdinBuffer;
+    } else if (ansilove_loadfile(&ctx, input) != ANSILOVE_OK) {
+        if (errno == ENOENT) {
+            fprintf(messages, "\nFile %s not found.\n\n", input);
+        } else {
+            fprintf(messages, "\nCan't read file %s: %s\n\n", input, strerror(errno));
+        }
+        return EXIT_FAILURE;
+    }
+
+    // let's check the file for a valid SAUCE record, it sits at the end
+    // of the buffer we already have
+    sauce *record = alSauceParseBuffer(ctx.buffer, ctx.length);
+
+    if (record == NULL) {
+        perror("Memory error");
+        ansilove_clean(&ctx);
+        free(stdinBuffer);
+        return 2;
+    }
+
+    // if we find a SAUCE record, update bool flag
+    if (!strcmp(record->ID, SAUCE_ID)) {
+        fileHasSAUCE = true;
+    }
+
+    if (!opts->justDisplaySAUCE) {
+        // create output file name if output is not specified
+        char *outputName;
+
+        if (opts->outputDir) {
+            // same name as the input file, inside the output directory
+            char *inputName = strrchr(input, '/');
+            inputName = inputName ? inputName + 1 : input;
+
+            int outputPathLen = strlen(opts->outputDir) + strlen(inputName) + 2;
+            outputPath = malloc(outputPathLen);
+
+            if (outputPath == NULL) {
+                perror("Memory error");
+                alSauceFree(record);
+                ansilove_clean(&ctx);
+                free(stdinBuffer);
+                return 2;
+            }
+
+            snprintf(outputPath, outputPathLen, "%s/%s", opts->outputDir, inputName);
+            outputName = outputPath;
+        } else {
+            outputName = input;
+        }
+
+        if (opts->toStdout) {
+            // kept in memory and written at once
+            ctx.outputs[0].path = NULL;
+            outputName = "-";
+        } else if (!opts->output) {
+            // appending the extension of the format to output file name
+            int outputLen = strlen(outputName) + strlen(formatExtension(opts->format)) + 1;
+            ctx.outputs[0].path = malloc(outputLen);
+
+            if (ctx.outputs[0].path) {
+                snprintf(ctx.outputs[0].path, outputLen, "%s%s", outputName,
+                         formatExtension(opts->format));
+            }
+        }
+        else {
+            outputName = opts->output;
+            ctx.outputs[0].path = strdup(outputName);
+        }
+
+        // without a path the image would only be kept in memory
+        if (!opts->toStdout && ctx.outputs[0].path == NULL) {
             perror("Memory error");
+            free(outputPath);
+            alSauceFree(record);
+            ansilove_clean(&ctx);
+            free(stdinBuffer);
             return 2;
         }
 
-        // copy the file into the buffer
-        if (fread(inputFileBuffer, 1, inputFileSize, input_file) != inputFileSize) {
-            perror("Reading error");
-            return 3;
-        } // whole file is now loaded into inputFileBuffer
-
-        inputFileBuffer[inputFileSize] = '\0';
-
-        // adjust the file size if file contains a SAUCE record
-        if(fileHasSAUCE) {
-            sauce *saucerec = sauceReadFile(input_file);
-            inputFileSize -= 129 - ( saucerec->comments > 0 ? 5 + 64 * saucerec->comments : 0);
-        }
-
-        // close input file, we don't need it anymore
-        fclose(input_file);
-
-        // create the output file by invoking the appropiate function
-        if (!strcmp(fext, ".pcb")) {
-            // params: input, output, font, bits, icecolors
-            pcboard(inputFileBuffer, inputFileSize, outputFile, retinaout, font, bits, createRetinaRep);
-            fileIsPCBoard = true;
-        } else if (!strcmp(fext, ".bin")) {
-            // params: input, output, columns, font, bits, icecolors
-            binary(inputFileBuffer, inputFileSize, outputFile, retinaout, columns, font, bits, icecolors, createRetinaRep);
-            fileIsBinary = true;
-        } else if (!strcmp(fext, ".adf")) {
-            // params: input, output, bits
-            artworx(inputFileBuffer, inputFileSize, outputFile, retinaout, createRetinaRep);
-        } else if (!strcmp(fext, ".idf")) {
-            // params: input, output, bits
-            icedraw(inputFileBuffer, inputFileSize, outputFile, retinaout, createRetinaRep);
-        } else if (!strcmp(fext, ".tnd")) {
-            tundra(inputFileBuffer, inputFileSize, outputFile, retinaout, font, bits, createRetinaRep);
-            fileIsTundra = true;
-        } else if (!strcmp(fext, ".xb")) {
-            // params: input, output, bits
-            xbin(inputFileBuffer, inputFileSize, outputFile, retinaout, createRetinaRep);
-        } else {
-            // params: input, output, font, bits, icecolors, fext
-            ansi(inputFileBuffer, inputFileSize, outputFile, retinaout, font, bits, mode, icecolors, fext, createRetinaRep);
-            fileIsANSi = true;
+        // the image itself comes first, then every scale
+        ctx.outputs[0].format = opts->format;
+
+        for (int32_t i = 0; i < opts->scaleCount; i++) {
+            ctx.outputs[i + 1] = opts->scales[i];
+            ctx.outputs[i + 1].format = opts->format;
+            ctx.outputs[i + 1].path = scalePath(&ctx.outputs[i + 1], outputName);
         }
 
-        // gather information and report to the command line
-        if (fileIsANSi || fileIsBinary ||
-            fileIsPCBoard || fileIsTundra) {
-            printf("Font: %s\n", font);
-            printf("Bits: %d\n", bits);
+        ctx.count = opts->scaleCount + 1;
+
+        // display name of input and output files
+        fprintf(messages, "\nInput File: %s\n", input);
+        fprintf(messages, "Output File: %s\n",
+                opts->toStdout ? "standard output" : ctx.outputs[0].path);
+
+        for (int32_t i = 1; i < ctx.count; i++) {
+            struct ansilove_output *scale = &ctx.outputs[i];
+
+            if (scale->factor == 2) {
+                fprintf(messages, "Retina Output File: %s\n", scale->path);
+            } else if (scale->divisor > 1) {
+                fprintf(messages, "Output File (1/%dx): %s\n", scale->divisor, scale->path);
+            } else {
+                fprintf(messages, "Output File (%dx): %s\n", scale->factor, scale->path);
+            }
         }
-        if (icecolors && (fileIsANSi || fileIsBinary)) {
-            printf("iCE Colors: enabled\n");
+
+        // create the output files by invoking the renderer the file
+        // extension asks for, a SAUCE record is left out
+        if (!opts->typeGiven) {
+            ansilove_filetype(&options, input);
         }
-        if (fileIsBinary) {
-            printf("Columns: %d\n", columns);
+
+        // images drawn before from the same input and options are copied
+        if (opts->cache) {
+            cacheKeys(&ctx, &options, keys);
+            cached = cacheFetch(opts->cache, &ctx, keys);
         }
+
+        if (!cached && ansilove_render(&ctx, &options) != ANSILOVE_OK) {
+            fprintf(messages, "\n%s: %s.\n\n", input, ansilove_error(&ctx));
+            status = EXIT_FAILURE;
+        } else if (opts->toStdout && !writeOutput(STDOUT_FILENO, &ctx.outputs[0])) {
+            fprintf(messages, "\nCan't write to standard output: %s\n\n", strerror(errno));
+            status = EXIT_FAILURE;
+        } else {
+            if (opts->cache) {
+                if (!cached) {
+                    cacheStore(opts->cache, &ctx, keys);
+                }
+
+                fprintf(messages, "Cache: %s\n", cached ? "hit" : "miss");
+            }
+
+            // report how much overdraw the screen saved
+            if (options.type == ANSILOVE_ANSI && ctx.drawn > 0) {
+                fprintf(messages, "Overdraw: %.2f (%d characters, %d drawn)\n",
+                        (double)ctx.characters / ctx.drawn, ctx.characters, ctx.drawn);
+            }
+
+            // output files are written at once, each took this long
+            if (opts->verbose && !cached) {
+                fprintf(messages, "Encoding Time: %.3f s\n", ctx.outputs[0].seconds);
+
+                for (int32_t i = 1; i < ctx.count; i++) {
+                    struct ansilove_output *scale = &ctx.outputs[i];
+
+                    if (scale->factor == 2) {
+                        fprintf(messages, "Retina Encoding Time: %.3f s\n", scale->seconds);
+                    } else if (scale->divisor > 1) {
+                        fprintf(messages, "Encoding Time (1/%dx): %.3f s\n", scale->divisor, scale->seconds);
+                    } else {
+                        fprintf(messages, "Encoding Time (%dx): %.3f s\n", scale->factor, scale->seconds);
+                    }
+                }
+            }
+
+            // gather information and report to the command line
+            if (options.type == ANSILOVE_ANSI || options.type == ANSILOVE_BINARY ||
+                options.type == ANSILOVE_PCBOARD || options.type == ANSILOVE_TUNDRA) {
+                fprintf(messages, "Font: %s\n", options.font);
+                fprintf(messages, "Bits: %d\n", options.bits);
+            }
+            if (options.icecolors &&
+                (options.type == ANSILOVE_ANSI || options.type == ANSILOVE_BINARY)) {
+                fprintf(messages, "iCE Colors: enabled\n");
+            }
+            if (options.type == ANSILOVE_BINARY) {
+                fprintf(messages, "Columns: %d\n", options.columns);
+            }
+        }
+    }
+
+    // free memory, there may be more files to come
+    for (int32_t i = 0; i < ctx.count; i++) {
+        free(ctx.outputs[i].path);
+    }
+
+    free(outputPath);
+    ansilove_clean(&ctx);
+    free(stdinBuffer);
+
+    if (status != EXIT_SUCCESS) {
+        alSauceFree(record);
+        return status;
     }
 
     // either display SAUCE or tell us if there is no record
     if (!fileHasSAUCE) {
-        printf("\nFile %s does not have a SAUCE record.\n", input);
+        fprintf(messages, "\nFile %s does not have a SAUCE record.\n", input);
     } else {
-        printf( "\nId: %s v%s\n", record->ID, record->version);
-        printf( "Title: %s\n", record->title );
-        printf( "Author: %s\n", record->author);
-        printf( "Group: %s\n", record->group);
-        printf( "Date: %s\n", record->date);
-        printf( "Datatype: %d\n", record->dataType);
-        printf( "Filetype: %d\n", record->fileType);
+        fprintf(messages, "\nId: %s v%s\n", record->ID, record->version);
+        fprintf(messages, "Title: %s\n", record->title );
+        fprintf(messages, "Author: %s\n", record->author);
+        fprintf(messages, "Group: %s\n", record->group);
+        fprintf(messages, "Date: %s\n", record->date);
+        fprintf(messages, "Datatype: %d\n", record->dataType);
+        fprintf(messages, "Filetype: %d\n", record->fileType);
         if (record->flags != 0) {
-            printf( "Flags: %d\n", record->flags);
+            fprintf(messages, "Flags: %d\n", record->flags);
         }
         if (record->tinfo1 != 0) {
-            printf( "Tinfo1: %d\n", record->tinfo1);
+            fprintf(messages, "Tinfo1: %d\n", record->tinfo1);
         }
         if (record->tinfo2 != 0) {
-            printf( "Tinfo2: %d\n", record->tinfo2);
+            fprintf(messages, "Tinfo2: %d\n", record->tinfo2);
         }
         if (record->tinfo3 != 0) {
-            printf( "Tinfo3: %d\n", record->tinfo3);
+            fprintf(messages, "Tinfo3: %d\n", record->tinfo3);
         }
         if (record->tinfo4 != 0) {
-            printf( "Tinfo4: %d\n", record->tinfo4);
+            fprintf(messages, "Tinfo4: %d\n", record->tinfo4);
         }
-        if (record->comments > 0) {
-            printf( "Comments: ");
+        if (record->comments > 0 && record->comment_lines != NULL) {
+            fprintf(messages, "Comments: ");
             for (int32_t i = 0; i < record->comments; i++) {
-                printf( "%s\n", record->comment_lines[i] );
+                fprintf(messages, "%s\n", record->comment_lines[i] );
             }
         }
     }
 
+    alSauceFree(record);
+
     return EXIT_SUCCESS;
 }
@@ -9,43 +9,945 @@
 //  See the file LICENSE for details.
 //
 
-#include "output.h"
+#define _XOPEN_SOURCE 700
 
-void output(gdImagePtr im_Source, char *output, char *retinaout, bool createRetinaRep) {
-    FILE *file_Out = fopen(output, "wb");
+#include <sys/stat.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include "ansilove.h"
 
-    if (file_Out) {
-        gdImagePng(im_Source, file_Out);
-        fclose(file_Out);
-    } else {
-        perror("Can't create output file");
-        exit(1);
+// number of source colors remembered by scaleimage(), a power of two
+#define SCALE_CACHE_SIZE 4096
+
+// the source row or column a thumbnail pixel shows, the middle of the
+// divisor pixels it stands for
+static int32_t scalesample(int32_t position, int32_t divisor, int32_t size)
+{
+    int64_t sample = (int64_t)position * divisor + divisor / 2;
+
+    return sample < size ? sample : size - 1;
+}
+
+int32_t alOutputRows(int32_t width, int32_t height)
+{
+    return width > 0 && height > 0 ? OUTPUT_PIXELS_MAX / ((int64_t)width * height) : 0;
+}
+
+int32_t alScaledSize(int32_t size, const struct ansilove_output *output)
+{
+    if (output->divisor > 1) {
+        return size / output->divisor > 0 ? size / output->divisor : 1;
     }
 
-    // in case Retina image output is wanted
-    if (createRetinaRep) {
-        gdImagePtr im_Retina;
+    return size * output->factor;
+}
 
-        // make the Retina image @2x as large as im_Source
-        im_Retina = gdImageCreate(im_Source->sx * 2, im_Source->sy * 2);
+// makes dst, a new palette image of src scaled, the same picture as
+// gdImageCopyResized would, without its per pixel bookkeeping. Colors
+// are resolved in the same order, and what a color resolves to never
+// changes afterwards: it is either allocated exactly or, once the palette
+// is full, matched against a palette that stays as it is. So a resolved
+// color can be remembered.
+static void scaleimage(gdImagePtr dst, gdImagePtr src, const struct ansilove_output *output)
+{
+    int32_t cache_color[SCALE_CACHE_SIZE], cache_index[SCALE_CACHE_SIZE];
+    int32_t transparent = gdImageGetTransparent(src);
+    int32_t factor = output->divisor > 1 ? 1 : output->factor;
+    int32_t x, y, source_x, source_y, color, slot, index, repeat;
+
+    for (slot = 0; slot < SCALE_CACHE_SIZE; slot++) {
+        cache_index[slot] = -1;
+    }
 
-        gdImageCopyResized(im_Retina, im_Source, 0, 0, 0, 0,
-                           im_Retina->sx, im_Retina->sy,
-                           im_Source->sx, im_Source->sy);
+    for (y = 0; y < gdImageSY(dst); y += factor) {
+        unsigned char *row = dst->pixels[y];
 
-        // create retina output image
-        FILE *file_RetinaOut = fopen(retinaout, "wb");
+        source_y = output->divisor > 1 ? scalesample(y, output->divisor, gdImageSY(src)) : y / factor;
 
-        if (file_RetinaOut) {
-            gdImagePng(im_Retina, file_RetinaOut);
-            fclose(file_RetinaOut);
+        for (x = 0; x < gdImageSX(dst); x += factor) {
+            source_x = output->divisor > 1 ? scalesample(x, output->divisor, gdImageSX(src)) : x / factor;
+            color = src->trueColor ? src->tpixels[source_y][source_x] : src->pixels[source_y][source_x];
+
+            // transparent pixels are left alone, as gdImageCopyResized does
+            if (color == transparent) {
+                continue;
+            }
+
+            slot = (uint32_t)color * 2654435761u >> 20 & (SCALE_CACHE_SIZE - 1);
+
+            if (cache_index[slot] >= 0 && cache_color[slot] == color) {
+                index = cache_index[slot];
+            } else {
+                index = gdImageColorResolveAlpha(dst, gdImageRed(src, color),
+                                                 gdImageGreen(src, color),
+                                                 gdImageBlue(src, color),
+                                                 gdImageAlpha(src, color));
+                cache_color[slot] = color;
+                cache_index[slot] = index;
+            }
+
+            memset(row + x, index, factor);
+        }
+
+        for (repeat = 1; repeat < factor; repeat++) {
+            memcpy(dst->pixels[y + repeat], row, gdImageSX(dst));
+        }
+    }
+}
+
+// processor seconds the calling thread spent since start, outputs are
+// made at once, so their own time is what gets reported
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// opens where a PNG output goes: its file, or a memory stream that
+// outputclose() hands over as the output's data
+static FILE *outputopen(const struct ansilove_output *output, char **memory, size_t *length)
+{
+    *memory = NULL;
+    *length = 0;
+
+    return output->path ? fopen(output->path, "wb") : open_memstream(memory, length);
+}
+
+static int outputclose(struct ansilove_output *output, FILE *file, char **memory,
+                       size_t *length, int error)
+{
+    int failed = output->path ? ANSILOVE_FILE_WRITE_ERROR : ANSILOVE_MEMORY_ERROR;
+    struct stat st;
+
+    if (ferror(file) && error == ANSILOVE_OK) {
+        error = failed;
+    }
+
+    if (fclose(file) != 0 && error == ANSILOVE_OK) {
+        error = failed;
+    }
+
+    // no partly written file is left behind, devices like /dev/stdout
+    // are never removed though
+    if (!output->path) {
+        if (error == ANSILOVE_OK) {
+            output->data = (unsigned char *)*memory;
+            output->length = *length;
         } else {
-            perror("Can't create output file");
-            exit(1);
+            free(*memory);
+        }
+    } else if (error != ANSILOVE_OK && stat(output->path, &st) == 0 && S_ISREG(st.st_mode)) {
+        unlink(output->path);
+    }
+
+    return error;
+}
+
+// bytes per pixel of a raw frame
+static int32_t framebytes(int32_t format)
+{
+    return format == ANSILOVE_RGBA ? 4 : format == ANSILOVE_RGB ? 3 : 1;
+}
+
+static void framenumber(unsigned char *bytes, uint32_t value, int32_t size)
+{
+    int32_t loop;
+
+    for (loop = 0; loop < size; loop++) {
+        bytes[loop] = value >> 8 * loop;
+    }
+}
+
+// writes the header of the raw frame of an output, then its palette of
+// colors entries
+static void framehead(FILE *file, const struct ansilove_output *output,
+                      const unsigned char (*palette)[4], int32_t colors)
+{
+    unsigned char header[ANSILOVE_FRAME_SIZE];
+
+    memcpy(header, "ALFB", 4);
+    framenumber(header + 4, output->width, 4);
+    framenumber(header + 8, output->height, 4);
+    header[12] = output->format;
+    header[13] = framebytes(output->format);
+    framenumber(header + 14, colors, 2);
+
+    fwrite(header, 1, ANSILOVE_FRAME_SIZE, file);
+    fwrite(palette, 4, colors, file);
+}
+
+// a color of an image libgd drew as red, green, blue and alpha
+static void gdcolor(gdImagePtr im, int32_t color, int32_t transparent, unsigned char *rgba)
+{
+    rgba[0] = gdImageRed(im, color);
+    rgba[1] = gdImageGreen(im, color);
+    rgba[2] = gdImageBlue(im, color);
+    rgba[3] = color == transparent ? 0 : 255 - gdImageAlpha(im, color) * 255 / gdAlphaMax;
+}
+
+// writes the pixels of an image libgd drew as a raw frame, indexed
+// frames are made of palette images only
+static int gdframe(gdImagePtr im, const struct ansilove_output *output, FILE *file)
+{
+    unsigned char palette[gdMaxColors][4];
+    int32_t transparent = gdImageGetTransparent(im);
+    int32_t colors = output->format == ANSILOVE_INDEXED ? gdImageColorsTotal(im) : 0;
+    int32_t bytes = framebytes(output->format);
+    unsigned char *row = malloc((size_t)gdImageSX(im) * bytes), *pixel, rgba[4];
+    int32_t x, y, color;
+
+    if (!row) {
+        return ANSILOVE_MEMORY_ERROR;
+    }
+
+    for (color = 0; color < colors; color++) {
+        gdcolor(im, color, transparent, palette[color]);
+    }
+
+    framehead(file, output, (const unsigned char (*)[4])palette, colors);
+
+    for (y = 0; y < gdImageSY(im); y++) {
+        if (colors > 0) {
+            fwrite(im->pixels[y], 1, gdImageSX(im), file);
+            continue;
         }
 
-        gdImageDestroy(im_Retina);
+        for (x = 0, pixel = row; x < gdImageSX(im); x++, pixel += bytes) {
+            gdcolor(im, gdImageGetPixel(im, x, y), transparent, rgba);
+            memcpy(pixel, rgba, bytes);
+        }
+
+        fwrite(row, bytes, gdImageSX(im), file);
+    }
+
+    free(row);
+
+    return ANSILOVE_OK;
+}
+
+// writes im, which is at the scale of the output already
+static int writeimage(gdImagePtr im, struct ansilove_output *output,
+                      const struct ansilove_options *options)
+{
+    char *memory;
+    size_t length;
+    FILE *file;
+
+    output->width = gdImageSX(im);
+    output->height = gdImageSY(im);
+
+    file = outputopen(output, &memory, &length);
+
+    if (!file) {
+        return output->path ? ANSILOVE_FILE_WRITE_ERROR : ANSILOVE_MEMORY_ERROR;
     }
 
+    if (output->format != ANSILOVE_PNG) {
+        return outputclose(output, file, &memory, &length, gdframe(im, output, file));
+    }
+
+    // libgd has no say in filters, so only the level applies here
+    gdImagePngEx(im, file, options->level);
+
+    return outputclose(output, file, &memory, &length, ANSILOVE_OK);
+}
+
+// the outputs alOutput() writes, taken in turn by its threads
+struct imageJob {
+    gdImagePtr source;
+    struct ansilove_ctx *ctx;
+    const struct ansilove_options *options;
+    int32_t next;
+    int error;
+    pthread_mutex_t lock;
+};
+
+static void *writeimages(void *arg)
+{
+    struct imageJob *job = arg;
+    struct ansilove_output *output;
+    struct timespec start;
+    gdImagePtr im;
+    int error;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        output = job->next < job->ctx->count ? &job->ctx->outputs[job->next++] : NULL;
+        pthread_mutex_unlock(&job->lock);
+
+        if (output == NULL) {
+            return NULL;
+        }
+
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+        // in case images at other scales are wanted, like Retina @2x, or
+        // a palette for a true color image, made the way scales get theirs
+        if (output->factor == 1 && output->divisor == 1 &&
+            (output->format != ANSILOVE_INDEXED || !job->source->trueColor)) {
+            im = job->source;
+        } else {
+            im = gdImageCreate(alScaledSize(job->source->sx, output),
+                               alScaledSize(job->source->sy, output));
+
+            if (im) {
+                scaleimage(im, job->source, output);
+            }
+        }
+
+        error = im ? writeimage(im, output, job->options) : ANSILOVE_MEMORY_ERROR;
+
+        if (im && im != job->source) {
+            gdImageDestroy(im);
+        }
+
+        output->seconds = elapsed(&start);
+
+        pthread_mutex_lock(&job->lock);
+        if (job->error == ANSILOVE_OK) {
+            job->error = error;
+        }
+        pthread_mutex_unlock(&job->lock);
+    }
+}
+
+int alOutput(gdImagePtr im_Source, struct ansilove_ctx *ctx,
+           const struct ansilove_options *options) {
+    pthread_t workers[ANSILOVE_OUTPUTS_MAX];
+    int32_t threads = options->threads, started = 0, loop;
+    struct imageJob job;
+
+    job.source = im_Source;
+    job.ctx = ctx;
+    job.options = options;
+    job.next = 0;
+    job.error = ANSILOVE_OK;
+
+    // the source is only read, so every image can be encoded at once,
+    // but each scaled one is held in memory while it is
+    if (threads > ctx->count) {
+        threads = ctx->count;
+    }
+
+    pthread_mutex_init(&job.lock, NULL);
+
+    for (loop = 1; loop < threads; loop++) {
+        if (pthread_create(&workers[started], NULL, writeimages, &job) == 0) {
+            started++;
+        }
+    }
+
+    writeimages(&job);
+
+    for (loop = 0; loop < started; loop++) {
+        pthread_join(workers[loop], NULL);
+    }
+
+    pthread_mutex_destroy(&job.lock);
+
     gdImageDestroy(im_Source);
+
+    return job.error;
+}
+
+// libpng can't go on after an error, it jumps back to whichever call
+// set png_jmpbuf() last
+static void pngerror(png_structp png, png_const_charp message)
+{
+    (void)message;
+    png_longjmp(png, 1);
+}
+
+static void pngwarning(png_structp png, png_const_charp message)
+{
+    (void)png;
+    (void)message;
+}
+
+// what went wrong once libpng gave up, writing the file or libpng itself
+static int pngfailed(FILE *file)
+{
+    return ferror(file) ? ANSILOVE_FILE_WRITE_ERROR : ANSILOVE_PNG_ERROR;
+}
+
+// finds the canvas colors a screen shows and gives each distinct one a
+// palette entry, the transparent color comes first so tRNS stays short
+static int compactpalette(struct compactPalette *pal, gdImagePtr canvas, int32_t height,
+                          const struct glyphAtlas *atlas, const struct screen *scr,
+                          const int32_t *backgrounds, const int32_t *foregrounds)
+{
+    bool used[gdMaxColors] = { false };
+    bool *ink = calloc(atlas->glyphs * 2, sizeof(bool)), *paper = ink + atlas->glyphs;
+    int32_t colors = gdImageColorsTotal(canvas);
+    int32_t transparent = gdImageGetTransparent(canvas);
+    int32_t glyph, pixel, position_x, position_y, loop, entry;
+
+    if (!ink) {
+        return ANSILOVE_MEMORY_ERROR;
+    }
+
+    // which glyphs show their foreground, their background, or both
+    for (glyph = 0; glyph < atlas->glyphs; glyph++) {
+        const unsigned char *mask = atlas->masks + (size_t)glyph * atlas->bits * atlas->height;
+
+        for (pixel = 0; pixel < atlas->bits * atlas->height; pixel++) {
+            if (mask[pixel]) {
+                ink[glyph] = true;
+            } else {
+                paper[glyph] = true;
+            }
+        }
+    }
+
+    // cells outside the canvas are never drawn
+    int32_t columns = (gdImageSX(canvas) + atlas->bits - 1) / atlas->bits;
+    int32_t rows = (height + atlas->height - 1) / atlas->height;
+
+    // the first color shows wherever no cell is drawn
+    used[0] = columns > scr->columns || rows > scr->rows;
+
+    if (columns > scr->columns) {
+        columns = scr->columns;
+    }
+    if (rows > scr->rows) {
+        rows = scr->rows;
+    }
+
+    for (position_y = 0; position_y < rows; position_y++) {
+        const struct screenCell *cell = scr->cells + (size_t)position_y * scr->columns;
+
+        for (position_x = 0; position_x < columns; position_x++, cell++) {
+            if (!cell->written) {
+                used[0] = true;
+                continue;
+            }
+
+            if (paper[cell->character]) {
+                used[backgrounds[cell->attribute >> 4]] = true;
+            }
+            if (ink[cell->character]) {
+                used[foregrounds[cell->attribute & 15]] = true;
+            }
+        }
+    }
+
+    free(ink);
+
+    // unused colors map to something valid all the same
+    memset(pal->map, 0, sizeof(pal->map));
+    pal->count = 0;
+    pal->transparent = -1;
+
+    if (transparent >= 0 && transparent < colors && used[transparent]) {
+        pal->transparent = pal->count++;
+        pal->colors[pal->transparent].red = gdImageRed(canvas, transparent);
+        pal->colors[pal->transparent].green = gdImageGreen(canvas, transparent);
+        pal->colors[pal->transparent].blue = gdImageBlue(canvas, transparent);
+        pal->map[transparent] = pal->transparent;
+    }
+
+    for (loop = 0; loop < colors; loop++) {
+        if (loop == transparent) {
+            continue;
+        }
+
+        if (!used[loop]) {
+            continue;
+        }
+
+        for (entry = pal->transparent + 1; entry < pal->count; entry++) {
+            if (pal->colors[entry].red == gdImageRed(canvas, loop) &&
+                pal->colors[entry].green == gdImageGreen(canvas, loop) &&
+                pal->colors[entry].blue == gdImageBlue(canvas, loop)) {
+                break;
+            }
+        }
+
+        if (entry == pal->count) {
+            pal->colors[entry].red = gdImageRed(canvas, loop);
+            pal->colors[entry].green = gdImageGreen(canvas, loop);
+            pal->colors[entry].blue = gdImageBlue(canvas, loop);
+            pal->count++;
+        }
+
+        pal->map[loop] = entry;
+    }
+
+    // an image needs at least one palette entry
+    if (pal->count == 0) {
+        pal->colors[0].red = pal->colors[0].green = pal->colors[0].blue = 0;
+        pal->count = 1;
+    }
+
+    return ANSILOVE_OK;
+}
+
+// starts a palette PNG, rows are then written one byte per pixel and
+// packed by libpng
+static int pngstart(png_structp *result, FILE *file, const struct compactPalette *pal,
+                    const struct ansilove_options *options, int32_t width, int32_t height)
+{
+    png_byte alpha[1] = { 0 };
+
+    // as few bits per pixel as the palette allows
+    int32_t depth = pal->count <= 2 ? 1 : pal->count <= 4 ? 2 : pal->count <= 16 ? 4 : 8;
+
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, pngerror, pngwarning);
+    png_infop info = png ? png_create_info_struct(png) : NULL;
+
+    if (!info) {
+        png_destroy_write_struct(&png, NULL);
+        return ANSILOVE_MEMORY_ERROR;
+    }
+
+    // libpng refuses images over a million pixels high by default, long
+    // scrolls are taller than that
+    png_set_user_limits(png, 0x7fffffff, 0x7fffffff);
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        return pngfailed(file);
+    }
+
+    png_init_io(png, file);
+    png_set_IHDR(png, info, width, height, depth, PNG_COLOR_TYPE_PALETTE,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_set_PLTE(png, info, pal->colors, pal->count);
+
+    // the transparent color is always the first entry
+    if (pal->transparent == 0) {
+        png_set_tRNS(png, info, alpha, 1, NULL);
+    }
+
+    png_set_filter(png, PNG_FILTER_TYPE_BASE, options->filters);
+    png_set_compression_level(png, options->level);
+
+    png_write_info(png, info);
+    png_set_packing(png);
+    png_destroy_info_struct(png, &info);
+
+    *result = png;
+
+    return ANSILOVE_OK;
+}
+
+static int pngfinish(png_structp png, FILE *file)
+{
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, NULL);
+        return pngfailed(file);
+    }
+
+    png_write_end(png, NULL);
+    png_destroy_write_struct(&png, NULL);
+
+    return ANSILOVE_OK;
+}
+
+// pixels in both bands of the image alOutputScreen() draws, each holds at
+// least one text row however wide the image is
+#define STREAM_QUEUE_BYTES (8 << 20)
+
+// bands of the image alOutputScreen() draws, handed to the threads
+// encoding its outputs. There are two, so the next band can be drawn
+// while the last one is still being encoded, and both are sized to fit
+// STREAM_QUEUE_BYTES together.
+struct bandQueue {
+    gdImagePtr bands[2];
+    int32_t first_line[2];
+    int32_t lines[2];
+    int32_t pending[2];
+    int32_t published;
+    bool finished;
+    int32_t width;
+    int32_t height;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+// an output written from the bands, as a PNG or as pixels. Once it
+// fails, the stream still takes bands, and hands them straight back.
+struct scaledStream {
+    struct ansilove_output *output;
+    struct bandQueue *queue;
+    FILE *file;
+    char *memory;
+    size_t length;
+    png_structp png;
+    unsigned char rgba[gdMaxColors][4];
+    unsigned char *pixels;
+    int32_t bytes;
+    unsigned char *row;
+    int32_t next_row;
+    int error;
+    pthread_t thread;
+    bool threaded;
+};
+
+static int streamopen(struct scaledStream *stream, const struct compactPalette *pal,
+                      const struct ansilove_options *options)
+{
+    struct ansilove_output *output = stream->output;
+    int32_t entry;
+
+    stream->row = malloc(output->width);
+
+    if (!stream->row) {
+        return ANSILOVE_MEMORY_ERROR;
+    }
+
+    stream->file = outputopen(output, &stream->memory, &stream->length);
+
+    if (!stream->file) {
+        return output->path ? ANSILOVE_FILE_WRITE_ERROR : ANSILOVE_MEMORY_ERROR;
+    }
+
+    if (output->format != ANSILOVE_PNG) {
+        stream->bytes = framebytes(output->format);
+        stream->pixels = malloc((size_t)output->width * stream->bytes);
+
+        if (!stream->pixels) {
+            return ANSILOVE_MEMORY_ERROR;
+        }
+
+        for (entry = 0; entry < pal->count; entry++) {
+            stream->rgba[entry][0] = pal->colors[entry].red;
+            stream->rgba[entry][1] = pal->colors[entry].green;
+            stream->rgba[entry][2] = pal->colors[entry].blue;
+            stream->rgba[entry][3] = entry == pal->transparent ? 0 : 255;
+        }
+
+        // rows of an indexed frame are the palette entries as drawn
+        framehead(stream->file, output, (const unsigned char (*)[4])stream->rgba,
+                  output->format == ANSILOVE_INDEXED ? pal->count : 0);
+
+        return ANSILOVE_OK;
+    }
+
+    return pngstart(&stream->png, stream->file, pal, options, output->width, output->height);
+}
+
+static void streamstart(struct scaledStream *stream, struct ansilove_output *output,
+                        const struct compactPalette *pal,
+                        const struct ansilove_options *options, struct bandQueue *queue)
+{
+    struct timespec start;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+    stream->output = output;
+    stream->queue = queue;
+    stream->file = NULL;
+    stream->png = NULL;
+    stream->pixels = NULL;
+    stream->row = NULL;
+    stream->next_row = 0;
+
+    output->width = alScaledSize(queue->width, output);
+    output->height = alScaledSize(queue->height, output);
+
+    stream->error = streamopen(stream, pal, options);
+
+    output->seconds = elapsed(&start);
+}
+
+// hands a finished row of palette entries to the PNG, or writes it to
+// the frame
+static void streamemit(struct scaledStream *stream, png_bytep row)
+{
+    const struct ansilove_output *output = stream->output;
+    unsigned char *pixel = stream->pixels;
+    int32_t column;
+
+    if (stream->png) {
+        png_write_row(stream->png, row);
+    } else if (stream->bytes == 1) {
+        fwrite(row, 1, output->width, stream->file);
+    } else {
+        if (stream->bytes == 4) {
+            for (column = 0; column < output->width; column++, pixel += 4) {
+                memcpy(pixel, stream->rgba[row[column]], 4);
+            }
+        } else {
+            for (column = 0; column < output->width; column++, pixel += 3) {
+                memcpy(pixel, stream->rgba[row[column]], 3);
+            }
+        }
+
+        fwrite(stream->pixels, stream->bytes, output->width, stream->file);
+    }
+
+    stream->next_row++;
+}
+
+// writes the rows made from source row y, which is width pixels wide:
+// factor copies of it enlarged, or the thumbnail rows that sample it
+static void streamrow(struct scaledStream *stream, unsigned char *pixels,
+                      int32_t y, int32_t width, int32_t height)
+{
+    const struct ansilove_output *output = stream->output;
+    int32_t column, repeat;
+
+    if (output->divisor > 1) {
+        while (stream->next_row < output->height &&
+               scalesample(stream->next_row, output->divisor, height) == y) {
+            for (column = 0; column < output->width; column++) {
+                stream->row[column] = pixels[scalesample(column, output->divisor, width)];
+            }
+
+            streamemit(stream, stream->row);
+        }
+        return;
+    }
+
+    // rows at their own size are written as they are
+    if (output->factor == 1) {
+        streamemit(stream, pixels);
+        return;
+    }
+
+    for (column = 0; column < width; column++) {
+        memset(stream->row + column * output->factor, pixels[column], output->factor);
+    }
+
+    for (repeat = 0; repeat < output->factor; repeat++) {
+        streamemit(stream, stream->row);
+    }
+}
+
+static void streamlines(struct scaledStream *stream, int32_t slot)
+{
+    struct bandQueue *queue = stream->queue;
+    int32_t line;
+
+    for (line = 0; line < queue->lines[slot]; line++) {
+        streamrow(stream, queue->bands[slot]->pixels[line], queue->first_line[slot] + line,
+                  queue->width, queue->height);
+    }
+}
+
+// writes the rows of one of the queued bands, then hands it back
+static void streamband(struct scaledStream *stream, int32_t slot)
+{
+    struct bandQueue *queue = stream->queue;
+    struct timespec start;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+    if (stream->error == ANSILOVE_OK) {
+        if (stream->png) {
+            if (setjmp(png_jmpbuf(stream->png))) {
+                stream->error = pngfailed(stream->file);
+            } else {
+                streamlines(stream, slot);
+            }
+        } else {
+            streamlines(stream, slot);
+        }
+    }
+
+    stream->output->seconds += elapsed(&start);
+
+    pthread_mutex_lock(&queue->lock);
+    if (--queue->pending[slot] == 0) {
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// encodes bands in the order they are published, until the last one
+static void *streambands(void *arg)
+{
+    struct scaledStream *stream = arg;
+    struct bandQueue *queue = stream->queue;
+    int32_t next;
+
+    for (next = 0;; next++) {
+        pthread_mutex_lock(&queue->lock);
+
+        while (queue->published == next && !queue->finished) {
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        }
+
+        if (queue->published == next) {
+            pthread_mutex_unlock(&queue->lock);
+            return NULL;
+        }
+
+        pthread_mutex_unlock(&queue->lock);
+
+        streamband(stream, next % 2);
+    }
+}
+
+static int streamfinish(struct scaledStream *stream)
+{
+    struct ansilove_output *output = stream->output;
+    struct timespec start;
+    int error = stream->error;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+    if (stream->png) {
+        if (error == ANSILOVE_OK) {
+            error = pngfinish(stream->png, stream->file);
+        } else {
+            png_destroy_write_struct(&stream->png, NULL);
+        }
+    }
+
+    if (stream->file) {
+        error = outputclose(output, stream->file, &stream->memory, &stream->length, error);
+    }
+
+    free(stream->pixels);
+    free(stream->row);
+
+    output->seconds += elapsed(&start);
+
+    return error;
+}
+
+int alOutputScreen(gdImagePtr canvas, int32_t height,
+                 const struct glyphAtlas *atlas, const struct screen *scr,
+                 const int32_t *backgrounds, const int32_t *foregrounds,
+                 struct ansilove_ctx *ctx, const struct ansilove_options *options)
+{
+    int32_t width = gdImageSX(canvas), threads = options->threads;
+    int32_t band_rows, first_row, line, slot;
+    struct compactPalette pal;
+    struct bandQueue queue;
+    struct scaledStream streams[ANSILOVE_OUTPUTS_MAX];
+    int32_t mapped_backgrounds[16], mapped_foregrounds[16], loop;
+    int error, finished;
+
+    if ((int64_t)width * height > OUTPUT_PIXELS_MAX) {
+        gdImageDestroy(canvas);
+        return ANSILOVE_RANGE_ERROR;
+    }
+
+    // cells are drawn straight in palette entries
+    error = compactpalette(&pal, canvas, height, atlas, scr, backgrounds, foregrounds);
+
+    if (error != ANSILOVE_OK) {
+        gdImageDestroy(canvas);
+        return error;
+    }
+
+    for (loop = 0; loop < 16; loop++) {
+        mapped_backgrounds[loop] = pal.map[backgrounds[loop]];
+        mapped_foregrounds[loop] = pal.map[foregrounds[loop]];
+    }
+
+    // the band height only depends on the image width, the drawing
+    // threads share the rows of a band between them
+    band_rows = STREAM_QUEUE_BYTES / (2 * (int64_t)width * atlas->height);
+
+    if (band_rows < 1) {
+        band_rows = 1;
+    }
+
+    if ((int64_t)band_rows * atlas->height > height) {
+        band_rows = (height + atlas->height - 1) / atlas->height;
+    }
+
+    queue.bands[0] = gdImageCreate(width, band_rows * atlas->height);
+    queue.bands[1] = queue.bands[0] ? gdImageCreate(width, band_rows * atlas->height) : NULL;
+
+    if (!queue.bands[1]) {
+        if (queue.bands[0]) {
+            gdImageDestroy(queue.bands[0]);
+        }
+
+        gdImageDestroy(canvas);
+        return ANSILOVE_MEMORY_ERROR;
+    }
+
+    queue.pending[0] = queue.pending[1] = 0;
+    queue.published = 0;
+    queue.finished = false;
+    queue.width = width;
+    queue.height = height;
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_cond_init(&queue.changed, NULL);
+
+    // Images at other scales, like Retina @2x, are made as the rows go.
+    // Every output is encoded on a thread of its own, outputs no thread
+    // could be started for are encoded here between bands.
+    for (loop = 0; loop < ctx->count; loop++) {
+        streamstart(&streams[loop], &ctx->outputs[loop], &pal, options, &queue);
+    }
+
+    for (loop = 0; loop < ctx->count; loop++) {
+        streams[loop].threaded = pthread_create(&streams[loop].thread, NULL,
+                                                 streambands, &streams[loop]) == 0;
+    }
+
+    ctx->drawn = 0;
+
+    for (first_row = 0; (int64_t)first_row * atlas->height < height; first_row += band_rows) {
+        slot = queue.published % 2;
+
+        // the band drawn two bands ago must be encoded everywhere first
+        pthread_mutex_lock(&queue.lock);
+        while (queue.pending[slot] > 0) {
+            pthread_cond_wait(&queue.changed, &queue.lock);
+        }
+        pthread_mutex_unlock(&queue.lock);
+
+        gdImagePtr band = queue.bands[slot];
+
+        for (line = 0; line < gdImageSY(band); line++) {
+            memset(band->pixels[line], pal.map[0], width);
+        }
+
+        ctx->drawn += alDrawScreen(band, atlas, scr, first_row, mapped_backgrounds,
+                                 mapped_foregrounds, threads);
+
+        pthread_mutex_lock(&queue.lock);
+        queue.first_line[slot] = first_row * atlas->height;
+        queue.lines[slot] = height - queue.first_line[slot];
+        if (queue.lines[slot] > gdImageSY(band)) {
+            queue.lines[slot] = gdImageSY(band);
+        }
+        queue.pending[slot] = ctx->count;
+        queue.published++;
+        pthread_cond_broadcast(&queue.changed);
+        pthread_mutex_unlock(&queue.lock);
+
+        for (loop = 0; loop < ctx->count; loop++) {
+            if (!streams[loop].threaded) {
+                streamband(&streams[loop], slot);
+            }
+        }
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    queue.finished = true;
+    pthread_cond_broadcast(&queue.changed);
+    pthread_mutex_unlock(&queue.lock);
+
+    for (loop = 0; loop < ctx->count; loop++) {
+        if (streams[loop].threaded) {
+            pthread_join(streams[loop].thread, NULL);
+        }
+
+        finished = streamfinish(&streams[loop]);
+
+        if (error == ANSILOVE_OK) {
+            error = finished;
+        }
+    }
+
+    pthread_cond_destroy(&queue.changed);
+    pthread_mutex_destroy(&queue.lock);
+
+    gdImageDestroy(queue.bands[0]);
+    gdImageDestroy(queue.bands[1]);
+    gdImageDestroy(canvas);
+
+    return error;
 }
@@ -12,12 +12,57 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include <gd.h>
+#include <png.h>
+#include "libansilove.h"
+#include "atlas.h"
+#include "screen.h"
 
 #ifndef output_h
 #define output_h
 
+// The largest image drawn, in pixels, as libgd never made larger ones.
+// Screens stop growing once their image would be larger.
+#define OUTPUT_PIXELS_MAX INT32_MAX
+
+// The palette a screen is written with. Only canvas colors that some
+// pixel shows get an entry, and colors that look the same share one, so
+// the bits per pixel are as few as possible.
+struct compactPalette {
+    int32_t map[gdMaxColors];
+    png_color colors[gdMaxColors];
+    int32_t count;
+    int32_t transparent;
+};
+
 // prototypes
-void output(gdImagePtr im_Source, char *output, char *retinaout, bool createRetinaRep);
+
+// Writes an image libgd drew to every output of the context, scaled as
+// each one asks, then destroys it. Returns an ANSILOVE_* error code.
+int alOutput(gdImagePtr im_Source, struct ansilove_ctx *ctx,
+           const struct ansilove_options *options);
+
+// width or height of an image at the scale of an output
+int32_t alScaledSize(int32_t size, const struct ansilove_output *output);
+
+// most text rows of the given height an image of the given width in
+// pixels may have, the limit of the screens drawn into it
+int32_t alOutputRows(int32_t width, int32_t height);
+
+// Draws a screen and writes it to every output of the context a band of
+// text rows at a time, so no whole image is ever held in memory unless
+// pixels are asked for. Each output is encoded on its own thread while
+// the next band is drawn. The canvas only provides the palette,
+// transparent color and width, height is the image height and pixels no
+// written cell covers get the first color, as on a new libgd canvas.
+// Destroys the canvas like alOutput() does, counts the cells drawn in
+// ctx->drawn and returns an ANSILOVE_* error code.
+int alOutputScreen(gdImagePtr canvas, int32_t height,
+                 const struct glyphAtlas *atlas, const struct screen *scr,
+                 const int32_t *backgrounds, const int32_t *foregrounds,
+                 struct ansilove_ctx *ctx, const struct ansilove_options *options);
 
 #endif
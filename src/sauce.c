@@ -11,119 +11,98 @@
 
 #include "sauce.h"
 
-// Reads SAUCE via a filename.
-sauce *sauceReadFileName(char *fileName)
+// Copies a fixed size field and terminates it.
+static const unsigned char *parseField(char *field, size_t size, const unsigned char *data)
 {
-    FILE *file = fopen(fileName, "r");
-    if (file == NULL) {
-        return NULL;
-    }
-
-    sauce *record = sauceReadFile(file);
-    fclose(file);
-    return record;
+    memcpy(field, data, size - 1);
+    field[size - 1] = '\0';
+    return data + size - 1;
 }
 
-// Read SAUCE via a FILE pointer.
-sauce *sauceReadFile(FILE *file)
+// Reads SAUCE from the end of a buffer, holding either the whole file or
+// just its tail. Buffers without a valid record still get one, with an
+// empty ID.
+sauce *alSauceParseBuffer(const unsigned char *buffer, size_t size)
 {
     sauce *record;
     record = malloc(sizeof *record);
 
-    if (record != NULL) {
-        readRecord(file, record);
-    }
-    return record;
-}
-
-void readRecord(FILE *file, sauce *record)
-{
-    if (fseek(file, 0 - RECORD_SIZE, SEEK_END) != EXIT_SUCCESS) {
-        free(record);
-        return;
+    if (record == NULL) {
+        return NULL;
     }
 
-    size_t read_status = fread(record->ID, sizeof(record->ID) - 1, 1, file);
-    record->ID[sizeof(record->ID) - 1] = '\0';
+    record->ID[0] = '\0';
+    record->comments = 0;
+    record->comment_lines = NULL;
 
-    if (read_status != 1 || strcmp(record->ID, SAUCE_ID) != 0) {
-        free(record);
-        return;
-    }
-    fread(record->version, sizeof(record->version) - 1, 1, file);
-    record->version[sizeof(record->version) - 1] = '\0';
-    fread(record->title, sizeof(record->title) - 1, 1, file);
-    record->title[sizeof(record->title) - 1] = '\0';
-    fread(record->author, sizeof(record->author) - 1, 1, file);
-    record->author[sizeof(record->author) - 1] = '\0';
-    fread(record->group, sizeof(record->group) - 1, 1, file);
-    record->group[sizeof(record->group) - 1] = '\0';
-    fread(record->date, sizeof(record->date) - 1, 1, file);
-    record->date[sizeof(record->date) - 1] = '\0';
-    fread(&(record->fileSize), sizeof(record->fileSize), 1, file);
-    fread(&(record->dataType), sizeof(record->dataType), 1, file);
-    fread(&(record->fileType), sizeof(record->fileType), 1, file);
-    fread(&(record->tinfo1), sizeof(record->tinfo1), 1, file);
-    fread(&(record->tinfo2), sizeof(record->tinfo2), 1, file);
-    fread(&(record->tinfo3), sizeof(record->tinfo3), 1, file);
-    fread(&(record->tinfo4), sizeof(record->tinfo4), 1, file);
-    fread(&(record->comments), sizeof(record->comments), 1, file);
-    fread(&(record->flags), sizeof(record->flags), 1, file);
-    fread(record->filler, sizeof(record->filler) - 1, 1, file);
-    record->filler[sizeof(record->filler) - 1] = '\0';
-
-    if (ferror(file) != EXIT_SUCCESS) {
-        free(record);
-        return;
+    if (size < RECORD_SIZE || memcmp(buffer + size - RECORD_SIZE, SAUCE_ID, 5) != 0) {
+        return record;
     }
 
+    // numbers are little-endian
+    const unsigned char *data = buffer + size - RECORD_SIZE;
+
+    data = parseField(record->ID, sizeof(record->ID), data);
+    data = parseField(record->version, sizeof(record->version), data);
+    data = parseField(record->title, sizeof(record->title), data);
+    data = parseField(record->author, sizeof(record->author), data);
+    data = parseField(record->group, sizeof(record->group), data);
+    data = parseField(record->date, sizeof(record->date), data);
+    record->fileSize = (int32_t)((uint32_t)data[0] | (uint32_t)data[1] << 8 |
+                                 (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+    record->dataType = data[4];
+    record->fileType = data[5];
+    record->tinfo1 = data[6] | data[7] << 8;
+    record->tinfo2 = data[8] | data[9] << 8;
+    record->tinfo3 = data[10] | data[11] << 8;
+    record->tinfo4 = data[12] | data[13] << 8;
+    record->comments = data[14];
+    record->flags = data[15];
+    parseField(record->filler, sizeof(record->filler), data + 16);
+
     if (record->comments > 0) {
-        record->comment_lines = malloc(record->comments *sizeof(*record->comment_lines));
+        size_t comments_size = 5 + COMMENT_SIZE * record->comments;
 
-        if (record->comment_lines != NULL) {
-            readComments(file, record->comment_lines, record->comments);
+        // a missing comment block only loses the comment lines, the
+        // number of comments still tells how much of the file is SAUCE
+        if (size < RECORD_SIZE + comments_size) {
+            return record;
         }
-        else {
-            free(record);
-            return;
-        }
-    }
-}
 
-void readComments(FILE *file, char **comment_lines, int32_t comments)
-{
-    int32_t i;
+        data = buffer + size - RECORD_SIZE - comments_size;
 
-    if (fseek(file, 0 - (RECORD_SIZE + 5 + COMMENT_SIZE *comments), SEEK_END) == EXIT_SUCCESS) {
-        char ID[6];
-        fread(ID, sizeof(ID) - 1, 1, file);
-        ID[sizeof(ID) - 1] = '\0';
-
-        if (strcmp(ID, COMMENT_ID) != 0) {
-            free(comment_lines);
-            return;
+        if (memcmp(data, COMMENT_ID, 5) != 0) {
+            return record;
         }
 
-        for (i = 0; i < comments; i++) {
-            char buf[COMMENT_SIZE + 1] = "";
+        record->comment_lines = calloc(record->comments, sizeof(*record->comment_lines));
 
-            fread(buf, COMMENT_SIZE, 1, file);
-            buf[COMMENT_SIZE] = '\0';
+        for (int32_t i = 0; record->comment_lines != NULL && i < record->comments; i++) {
+            record->comment_lines[i] = strndup((const char *)data + 5 + COMMENT_SIZE * i, COMMENT_SIZE);
 
-            if (ferror(file) == EXIT_SUCCESS) {
-                comment_lines[i] = strdup(buf);
-                if (comment_lines[i] == NULL) {
-                    free(comment_lines);
-                    return;
+            if (record->comment_lines[i] == NULL) {
+                while (i--) {
+                    free(record->comment_lines[i]);
                 }
-            }
-            else {
-                free(comment_lines);
-                return;
+                free(record->comment_lines);
+                record->comment_lines = NULL;
             }
         }
+    }
+
+    return record;
+}
+
+// Frees a record and its comments.
+void alSauceFree(sauce *record)
+{
+    if (record == NULL) {
         return;
     }
-    free(comment_lines);
-    return;
+
+    for (int32_t i = 0; record->comment_lines != NULL && i < record->comments; i++) {
+        free(record->comment_lines[i]);
+    }
+    free(record->comment_lines);
+    free(record);
 }
@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 
 #ifndef sauce_h
@@ -44,9 +45,7 @@ typedef struct {
     char             **comment_lines;
 } sauce;
 
-sauce *sauceReadFileName(char *fileName);
-sauce *sauceReadFile(FILE *file);
-void  readRecord(FILE *file, sauce *record);
-void  readComments(FILE *file, char **comment_lines, int32_t comments);
+sauce *alSauceParseBuffer(const unsigned char *buffer, size_t size);
+void  alSauceFree(sauce *record);
 
 #endif
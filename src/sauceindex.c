@@ -0,0 +1,429 @@
+//
+//  sauceindex.c
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include "sauceindex.h"
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// characters 128 to 255 of code page 437, which SAUCE text is written in
+static const uint16_t cp437[128] = {
+    0x00c7, 0x00fc, 0x00e9, 0x00e2, 0x00e4, 0x00e0, 0x00e5, 0x00e7,
+    0x00ea, 0x00eb, 0x00e8, 0x00ef, 0x00ee, 0x00ec, 0x00c4, 0x00c5,
+    0x00c9, 0x00e6, 0x00c6, 0x00f4, 0x00f6, 0x00f2, 0x00fb, 0x00f9,
+    0x00ff, 0x00d6, 0x00dc, 0x00a2, 0x00a3, 0x00a5, 0x20a7, 0x0192,
+    0x00e1, 0x00ed, 0x00f3, 0x00fa, 0x00f1, 0x00d1, 0x00aa, 0x00ba,
+    0x00bf, 0x2310, 0x00ac, 0x00bd, 0x00bc, 0x00a1, 0x00ab, 0x00bb,
+    0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+    0x2555, 0x2563, 0x2551, 0x2557, 0x255d, 0x255c, 0x255b, 0x2510,
+    0x2514, 0x2534, 0x252c, 0x251c, 0x2500, 0x253c, 0x255e, 0x255f,
+    0x255a, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256c, 0x2567,
+    0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256b,
+    0x256a, 0x2518, 0x250c, 0x2588, 0x2584, 0x258c, 0x2590, 0x2580,
+    0x03b1, 0x00df, 0x0393, 0x03c0, 0x03a3, 0x03c3, 0x00b5, 0x03c4,
+    0x03a6, 0x0398, 0x03a9, 0x03b4, 0x221e, 0x03c6, 0x03b5, 0x2229,
+    0x2261, 0x00b1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00f7, 0x2248,
+    0x00b0, 0x2219, 0x00b7, 0x221a, 0x207f, 0x00b2, 0x25a0, 0x00a0
+};
+
+// a file waiting to be indexed, or its finished line
+struct indexEntry {
+    char *path;
+    off_t size;
+    char *line;
+    size_t lineSize;
+    bool done;
+};
+
+// files found by the walker and taken by the workers, a ring buffer which
+// is printed from in the order files were found
+struct indexQueue {
+    struct indexEntry *entries;
+    int64_t queued;
+    int64_t taken;
+    int64_t printed;
+    bool walked;
+    int32_t format;
+    int status;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+// writes text escaped for a JSON or CSV string, SAUCE text is converted
+// from code page 437 to UTF-8 and trailing padding is dropped
+static void indexChars(FILE *out, const char *text, bool fromCP437, int32_t format)
+{
+    size_t length = strlen(text);
+
+    if (fromCP437) {
+        while (length > 0 && text[length - 1] == ' ') {
+            length--;
+        }
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = text[i];
+
+        if (c == '"') {
+            fputs(format == INDEX_JSONL ? "\\\"" : "\"\"", out);
+        } else if (c == '\\' && format == INDEX_JSONL) {
+            fputs("\\\\", out);
+        } else if (c < 0x20 && format == INDEX_JSONL) {
+            fprintf(out, "\\u%04x", c);
+        } else if (c >= 0x80 && fromCP437) {
+            uint16_t code = cp437[c - 0x80];
+
+            if (code < 0x800) {
+                fputc(0xc0 | code >> 6, out);
+            } else {
+                fputc(0xe0 | code >> 12, out);
+                fputc(0x80 | (code >> 6 & 0x3f), out);
+            }
+            fputc(0x80 | (code & 0x3f), out);
+        } else {
+            fputc(c, out);
+        }
+    }
+}
+
+// writes text as a quoted JSON or CSV string
+static void indexText(FILE *out, const char *text, bool fromCP437, int32_t format)
+{
+    fputc('"', out);
+    indexChars(out, text, fromCP437, format);
+    fputc('"', out);
+}
+
+// formats the line of a record
+static void indexRecord(FILE *out, const char *path, sauce *record, int32_t format)
+{
+    int32_t i;
+
+    if (format == INDEX_JSONL) {
+        fputs("{\"path\":", out);
+        indexText(out, path, false, format);
+        fputs(",\"id\":", out);
+        indexText(out, record->ID, true, format);
+        fputs(",\"version\":", out);
+        indexText(out, record->version, true, format);
+        fputs(",\"title\":", out);
+        indexText(out, record->title, true, format);
+        fputs(",\"author\":", out);
+        indexText(out, record->author, true, format);
+        fputs(",\"group\":", out);
+        indexText(out, record->group, true, format);
+        fputs(",\"date\":", out);
+        indexText(out, record->date, true, format);
+        fprintf(out, ",\"fileSize\":%d,\"dataType\":%d,\"fileType\":%d,"
+                "\"tinfo1\":%d,\"tinfo2\":%d,\"tinfo3\":%d,\"tinfo4\":%d,"
+                "\"comments\":%d,\"flags\":%d,\"filler\":",
+                record->fileSize, record->dataType, record->fileType,
+                record->tinfo1, record->tinfo2, record->tinfo3, record->tinfo4,
+                record->comments, record->flags);
+        indexText(out, record->filler, true, format);
+        fputs(",\"commentLines\":[", out);
+
+        for (i = 0; record->comment_lines != NULL && i < record->comments; i++) {
+            if (i > 0) {
+                fputc(',', out);
+            }
+            indexText(out, record->comment_lines[i], true, format);
+        }
+
+        fputs("]}\n", out);
+    } else {
+        indexText(out, path, false, format);
+        fputc(',', out);
+        indexText(out, record->ID, true, format);
+        fputc(',', out);
+        indexText(out, record->version, true, format);
+        fputc(',', out);
+        indexText(out, record->title, true, format);
+        fputc(',', out);
+        indexText(out, record->author, true, format);
+        fputc(',', out);
+        indexText(out, record->group, true, format);
+        fputc(',', out);
+        indexText(out, record->date, true, format);
+        fprintf(out, ",%d,%d,%d,%d,%d,%d,%d,%d,%d,",
+                record->fileSize, record->dataType, record->fileType,
+                record->tinfo1, record->tinfo2, record->tinfo3, record->tinfo4,
+                record->comments, record->flags);
+        indexText(out, record->filler, true, format);
+        fputc(',', out);
+
+        // comment lines share a single field, one per line
+        fputc('"', out);
+
+        for (i = 0; record->comment_lines != NULL && i < record->comments; i++) {
+            if (i > 0) {
+                fputc('\n', out);
+            }
+            indexChars(out, record->comment_lines[i], true, format);
+        }
+
+        fputs("\"\r\n", out);
+    }
+}
+
+// reads the tail of a file and formats its record, if it has one
+static int indexFile(struct indexEntry *entry, unsigned char *tail, int32_t format)
+{
+    off_t offset = entry->size > INDEX_TAIL_SIZE ? entry->size - INDEX_TAIL_SIZE : 0;
+    ssize_t length;
+
+    int fd = open(entry->path, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "%s: %s\n", entry->path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    length = pread(fd, tail, entry->size - offset, offset);
+    close(fd);
+
+    if (length == -1) {
+        fprintf(stderr, "%s: %s\n", entry->path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    sauce *record = alSauceParseBuffer(tail, length);
+    if (record == NULL) {
+        perror("Memory error");
+        exit(2);
+    }
+
+    if (!strcmp(record->ID, SAUCE_ID)) {
+        FILE *out = open_memstream(&entry->line, &entry->lineSize);
+        if (out == NULL) {
+            perror("Memory error");
+            exit(2);
+        }
+
+        indexRecord(out, entry->path, record, format);
+        fclose(out);
+    }
+
+    alSauceFree(record);
+
+    return EXIT_SUCCESS;
+}
+
+// indexes queued files until the walker is done and none are left, then
+// prints every finished line whose predecessors are printed already
+static void *indexWorker(void *arg)
+{
+    struct indexQueue *queue = arg;
+    struct indexEntry *entry;
+    unsigned char *tail = malloc(INDEX_TAIL_SIZE);
+
+    if (tail == NULL) {
+        perror("Memory error");
+        exit(2);
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+
+        while (queue->taken == queue->queued && !queue->walked) {
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        }
+
+        if (queue->taken == queue->queued) {
+            pthread_mutex_unlock(&queue->lock);
+            free(tail);
+            return NULL;
+        }
+
+        entry = &queue->entries[queue->taken++ % INDEX_QUEUE_SIZE];
+        pthread_mutex_unlock(&queue->lock);
+
+        int status = indexFile(entry, tail, queue->format);
+
+        pthread_mutex_lock(&queue->lock);
+        entry->done = true;
+
+        if (status != EXIT_SUCCESS) {
+            queue->status = EXIT_FAILURE;
+        }
+
+        while (queue->printed < queue->taken &&
+               queue->entries[queue->printed % INDEX_QUEUE_SIZE].done) {
+            entry = &queue->entries[queue->printed++ % INDEX_QUEUE_SIZE];
+
+            if (entry->line != NULL) {
+                fwrite(entry->line, 1, entry->lineSize, stdout);
+                free(entry->line);
+            }
+            free(entry->path);
+        }
+
+        pthread_cond_broadcast(&queue->changed);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
+
+// records a failure, the workers may be doing the same
+static void indexFailed(struct indexQueue *queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->status = EXIT_FAILURE;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// hands a file to the workers, waiting while the queue is full
+static void indexQueueFile(struct indexQueue *queue, char *path, off_t size)
+{
+    pthread_mutex_lock(&queue->lock);
+
+    while (queue->queued - queue->printed == INDEX_QUEUE_SIZE) {
+        pthread_cond_wait(&queue->changed, &queue->lock);
+    }
+
+    struct indexEntry *entry = &queue->entries[queue->queued++ % INDEX_QUEUE_SIZE];
+
+    entry->path = path;
+    entry->size = size;
+    entry->line = NULL;
+    entry->lineSize = 0;
+    entry->done = false;
+
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// queues regular files, directories are walked in name order, symbolic
+// links inside them are not followed
+static void indexWalk(struct indexQueue *queue, const char *path, const struct stat *st)
+{
+    if (S_ISREG(st->st_mode)) {
+        char *copy = strdup(path);
+        if (copy == NULL) {
+            perror("Memory error");
+            exit(2);
+        }
+
+        indexQueueFile(queue, copy, st->st_size);
+        return;
+    }
+
+    if (!S_ISDIR(st->st_mode)) {
+        return;
+    }
+
+    struct dirent **names;
+    int count = scandir(path, &names, NULL, alphasort);
+
+    if (count == -1) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        indexFailed(queue);
+        return;
+    }
+
+    int dir = open(path, O_RDONLY | O_DIRECTORY);
+
+    for (int i = 0; i < count; i++) {
+        const char *name = names[i]->d_name;
+        struct stat child;
+
+        if (strcmp(name, ".") && strcmp(name, "..") && dir != -1 &&
+            fstatat(dir, name, &child, AT_SYMLINK_NOFOLLOW) == 0) {
+            size_t length = strlen(path) + strlen(name) + 2;
+            char *childPath = malloc(length);
+            if (childPath == NULL) {
+                perror("Memory error");
+                exit(2);
+            }
+
+            snprintf(childPath, length, "%s%s%s", path,
+                     path[strlen(path) - 1] == '/' ? "" : "/", name);
+            indexWalk(queue, childPath, &child);
+            free(childPath);
+        }
+
+        free(names[i]);
+    }
+
+    if (dir != -1) {
+        close(dir);
+    }
+    free(names);
+}
+
+int sauceIndex(char **paths, int32_t count, int32_t jobs, int32_t format)
+{
+    pthread_t *workers = malloc(jobs * sizeof(pthread_t));
+    int32_t started = 0, i;
+    struct indexQueue queue;
+    struct stat st;
+
+    queue.entries = malloc(INDEX_QUEUE_SIZE * sizeof(struct indexEntry));
+
+    if (workers == NULL || queue.entries == NULL) {
+        perror("Memory error");
+        return 2;
+    }
+
+    queue.queued = 0;
+    queue.taken = 0;
+    queue.printed = 0;
+    queue.walked = false;
+    queue.format = format;
+    queue.status = EXIT_SUCCESS;
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_cond_init(&queue.changed, NULL);
+
+    if (format == INDEX_CSV) {
+        printf("path,id,version,title,author,group,date,fileSize,dataType,fileType,"
+               "tinfo1,tinfo2,tinfo3,tinfo4,comments,flags,filler,commentLines\r\n");
+    }
+
+    for (i = 0; i < jobs; i++) {
+        if (pthread_create(&workers[started], NULL, indexWorker, &queue) == 0) {
+            started++;
+        }
+    }
+
+    if (started == 0) {
+        perror("Can't start index threads");
+        return EXIT_FAILURE;
+    }
+
+    // the calling thread walks, paths given explicitly may be links
+    for (i = 0; i < count; i++) {
+        if (stat(paths[i], &st)) {
+            fprintf(stderr, "%s: %s\n", paths[i], strerror(errno));
+            indexFailed(&queue);
+            continue;
+        }
+
+        indexWalk(&queue, paths[i], &st);
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    queue.walked = true;
+    pthread_cond_broadcast(&queue.changed);
+    pthread_mutex_unlock(&queue.lock);
+
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&queue.changed);
+    pthread_mutex_destroy(&queue.lock);
+    free(queue.entries);
+    free(workers);
+
+    fflush(stdout);
+
+    return queue.status;
+}
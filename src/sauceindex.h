@@ -0,0 +1,39 @@
+//
+//  sauceindex.h
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "sauce.h"
+
+#ifndef sauceindex_h
+#define sauceindex_h
+
+// index output formats
+#define INDEX_JSONL 1
+#define INDEX_CSV   2
+
+// number of files queued ahead of the workers
+#define INDEX_QUEUE_SIZE 4096
+
+// the most a SAUCE record and its comments can take at the end of a file
+#define INDEX_TAIL_SIZE (RECORD_SIZE + 5 + COMMENT_SIZE * 255)
+
+// Walks files and directories and prints the SAUCE record of every file
+// that has one, reading only the tail of each file. Files are read on
+// jobs threads, records are printed in the order they were found.
+int sauceIndex(char **paths, int32_t count, int32_t jobs, int32_t format);
+
+#endif
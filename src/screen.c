@@ -0,0 +1,94 @@
+//
+//  screen.c
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include "screen.h"
+
+void alScreenInit(struct screen *scr, int32_t columns, int32_t limit)
+{
+    scr->cells = NULL;
+    scr->columns = columns;
+    scr->rows = 0;
+    scr->capacity = 0;
+    scr->limit = limit;
+    scr->error = ANSILOVE_OK;
+}
+
+void alScreenFree(struct screen *scr)
+{
+    free(scr->cells);
+    alScreenInit(scr, scr->columns, scr->limit);
+}
+
+bool alScreenGrow(struct screen *scr, int32_t rows)
+{
+    size_t rowSize = (size_t)scr->columns * sizeof(struct screenCell);
+
+    if (rows <= scr->rows) {
+        return true;
+    }
+
+    // checked before anything is allocated, a single cursor movement
+    // can ask for millions of rows
+    if (rows > scr->limit) {
+        scr->error = ANSILOVE_RANGE_ERROR;
+        return false;
+    }
+
+    // the row capacity doubles whenever it runs out, but never past the
+    // limit
+    if (rows > scr->capacity) {
+        int32_t capacity = scr->capacity ? scr->capacity : 64;
+
+        while (capacity < rows) {
+            capacity = capacity > INT32_MAX / 2 ? INT32_MAX : capacity * 2;
+        }
+
+        if (capacity > scr->limit) {
+            capacity = scr->limit;
+        }
+
+        struct screenCell *cells = realloc(scr->cells, capacity * rowSize);
+        if (cells == NULL) {
+            scr->error = ANSILOVE_MEMORY_ERROR;
+            return false;
+        }
+
+        scr->cells = cells;
+        scr->capacity = capacity;
+    }
+
+    memset(scr->cells + (size_t)scr->rows * scr->columns, 0, (rows - scr->rows) * rowSize);
+    scr->rows = rows;
+
+    return true;
+}
+
+void alScreenClear(struct screen *scr)
+{
+    scr->rows = 0;
+}
+
+void alScreenPut(struct screen *scr, int32_t x, int32_t y, int32_t character, int32_t attribute)
+{
+    if (x < 0 || x >= scr->columns || y < 0) {
+        return;
+    }
+
+    if (!alScreenGrow(scr, y + 1)) {
+        return;
+    }
+
+    struct screenCell *cell = scr->cells + (size_t)y * scr->columns + x;
+
+    cell->character = character;
+    cell->attribute = attribute;
+    cell->written = true;
+}
@@ -0,0 +1,59 @@
+//
+//  screen.h
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "libansilove.h"
+
+#ifndef screen_h
+#define screen_h
+
+// A screen is a dense, row-major buffer of text mode cells. Every cell
+// holds a character, up to 512 of them for XBin, and its attribute,
+// foreground in the low nibble and background in the high nibble. Rows
+// are added as they are needed, new cells are marked as never written,
+// up to limit rows. Once rows couldn't be added, error is set to
+// ANSILOVE_MEMORY_ERROR, or ANSILOVE_RANGE_ERROR past the limit, and
+// further cells below the screen are dropped, loaders check it before
+// drawing.
+
+struct screenCell {
+    uint16_t character;
+    unsigned char attribute;
+    bool written;
+};
+
+struct screen {
+    struct screenCell *cells;
+    int32_t columns;
+    int32_t rows;
+    int32_t capacity;
+    int32_t limit;
+    int error;
+};
+
+void alScreenInit(struct screen *scr, int32_t columns, int32_t limit);
+void alScreenFree(struct screen *scr);
+
+// makes sure the screen has at least rows rows, when they are past the
+// limit or there is no memory for them it returns false and sets error
+bool alScreenGrow(struct screen *scr, int32_t rows);
+
+// removes all rows
+void alScreenClear(struct screen *scr);
+
+// writes a cell, cells left of the screen, right of it or above it are dropped
+void alScreenPut(struct screen *scr, int32_t x, int32_t y, int32_t character, int32_t attribute);
+
+#endif
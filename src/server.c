@@ -0,0 +1,378 @@
+//
+//  server.c
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#include "server.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ansilove.h"
+
+// the listening socket, shared by all workers
+struct serverPool {
+    int listener;
+    const struct ansilove_options *defaults;
+    int32_t threads;
+};
+
+// reads exactly length bytes, false at the end of the connection
+static bool serverRead(int fd, void *buffer, size_t length)
+{
+    unsigned char *next = buffer;
+    ssize_t count;
+
+    while (length > 0) {
+        count = read(fd, next, length);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            return false;
+        }
+
+        next += count;
+        length -= count;
+    }
+
+    return true;
+}
+
+static bool serverWrite(int fd, const void *buffer, size_t length)
+{
+    const unsigned char *next = buffer;
+    ssize_t count;
+
+    while (length > 0) {
+        count = write(fd, next, length);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            return false;
+        }
+
+        next += count;
+        length -= count;
+    }
+
+    return true;
+}
+
+static bool serverNumber(int fd, uint32_t *value)
+{
+    unsigned char bytes[4];
+
+    if (!serverRead(fd, bytes, 4)) {
+        return false;
+    }
+
+    *value = (uint32_t)bytes[0] << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
+
+    return true;
+}
+
+static void serverPut(unsigned char *bytes, uint32_t value)
+{
+    bytes[0] = value >> 24;
+    bytes[1] = value >> 16;
+    bytes[2] = value >> 8;
+    bytes[3] = value;
+}
+
+static bool serverRespond(int fd, int status, uint32_t microseconds,
+                          const struct ansilove_output *output,
+                          const void *data, size_t length)
+{
+    unsigned char header[SERVER_RESPONSE_SIZE];
+
+    serverPut(header, status);
+    serverPut(header + 4, microseconds);
+    serverPut(header + 8, output ? output->width : 0);
+    serverPut(header + 12, output ? output->height : 0);
+    serverPut(header + 16, length);
+
+    return serverWrite(fd, header, SERVER_RESPONSE_SIZE) && serverWrite(fd, data, length);
+}
+
+// takes the key=value pairs of a job, values stay in options
+static bool serverOptions(char *text, struct ansilove_options *options,
+                          struct ansilove_output *output)
+{
+    const char *errstr = NULL;
+    char *pair, *value, *last;
+
+    for (pair = strtok_r(text, " \t\r\n", &last); pair;
+         pair = strtok_r(NULL, " \t\r\n", &last)) {
+        value = strchr(pair, '=');
+
+        if (value == NULL) {
+            return false;
+        }
+
+        *value++ = '\0';
+
+        if (!strcmp(pair, "name")) {
+            ansilove_filetype(options, value);
+        } else if (!strcmp(pair, "font")) {
+            options->font = value;
+        } else if (!strcmp(pair, "bits")) {
+            options->bits = strtonum(value, 8, 9, &errstr);
+        } else if (!strcmp(pair, "columns")) {
+            options->columns = strtonum(value, 1, 8192, &errstr);
+        } else if (!strcmp(pair, "ice")) {
+            options->icecolors = strtonum(value, 0, 1, &errstr);
+        } else if (!strcmp(pair, "level")) {
+            options->level = strtonum(value, 0, 9, &errstr);
+        } else if (!strcmp(pair, "mode")) {
+            if (!strcmp(value, "ced")) {
+                options->mode = ANSILOVE_MODE_CED;
+            } else if (!strcmp(value, "transparent")) {
+                options->mode = ANSILOVE_MODE_TRANSPARENT;
+            } else if (!strcmp(value, "workbench")) {
+                options->mode = ANSILOVE_MODE_WORKBENCH;
+            } else {
+                return false;
+            }
+        } else if (!strcmp(pair, "filter")) {
+            if (!strcmp(value, "none")) {
+                options->filters = ANSILOVE_FILTER_NONE;
+            } else if (!strcmp(value, "sub")) {
+                options->filters = ANSILOVE_FILTER_SUB;
+            } else if (!strcmp(value, "up")) {
+                options->filters = ANSILOVE_FILTER_UP;
+            } else if (!strcmp(value, "adaptive")) {
+                options->filters = ANSILOVE_FILTER_ADAPTIVE;
+            } else {
+                return false;
+            }
+        } else if (!strcmp(pair, "format")) {
+            if (!strcmp(value, "png")) {
+                output->format = ANSILOVE_PNG;
+            } else if (!strcmp(value, "rgba")) {
+                output->format = ANSILOVE_RGBA;
+            } else if (!strcmp(value, "rgb")) {
+                output->format = ANSILOVE_RGB;
+            } else if (!strcmp(value, "indexed")) {
+                output->format = ANSILOVE_INDEXED;
+            } else {
+                return false;
+            }
+        } else if (!strcmp(pair, "scale")) {
+            if (!strncmp(value, "1/", 2)) {
+                output->divisor = strtonum(value + 2, 2, 64, &errstr);
+            } else {
+                output->factor = strtonum(value, 1, 16, &errstr);
+            }
+        } else {
+            return false;
+        }
+
+        if (errstr) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// reads a job from in and writes its response to out, false once the
+// connection ends or can't be trusted anymore
+static bool serverJob(int in, int out, const struct ansilove_options *defaults, int32_t threads)
+{
+    struct ansilove_ctx ctx;
+    struct ansilove_options options;
+    struct timespec start, end;
+    char text[SERVER_OPTIONS_MAX + 1];
+    uint32_t length;
+    int status;
+    bool alive;
+
+    if (!serverNumber(in, &length)) {
+        return false;
+    }
+
+    if (length > SERVER_OPTIONS_MAX) {
+        serverRespond(out, ANSILOVE_RANGE_ERROR, 0, NULL, "Options too long", 16);
+        return false;
+    }
+
+    if (!serverRead(in, text, length)) {
+        return false;
+    }
+
+    text[length] = '\0';
+
+    if (!serverNumber(in, &length)) {
+        return false;
+    }
+
+    // the rest of the job can't be skipped safely
+    if (length > SERVER_INPUT_MAX) {
+        serverRespond(out, ANSILOVE_RANGE_ERROR, 0, NULL, "Input too large", 15);
+        return false;
+    }
+
+    ansilove_init(&ctx, &options);
+    options = *defaults;
+    options.threads = threads;
+
+    unsigned char *input = malloc(length ? length : 1);
+
+    if (input == NULL) {
+        return false;
+    }
+
+    if (!serverRead(in, input, length)) {
+        free(input);
+        return false;
+    }
+
+    ctx.buffer = input;
+    ctx.length = length;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    status = serverOptions(text, &options, &ctx.outputs[0]) ?
+        ansilove_render(&ctx, &options) : (ctx.error = ANSILOVE_INVALID_PARAM);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int64_t microseconds = (end.tv_sec - start.tv_sec) * 1000000 +
+        (end.tv_nsec - start.tv_nsec) / 1000;
+
+    if (microseconds > UINT32_MAX) {
+        microseconds = UINT32_MAX;
+    }
+
+    if (status == ANSILOVE_OK) {
+        alive = serverRespond(out, status, microseconds, &ctx.outputs[0],
+                              ctx.outputs[0].data, ctx.outputs[0].length);
+    } else {
+        const char *message = ansilove_error(&ctx);
+
+        alive = serverRespond(out, status, microseconds, NULL, message, strlen(message));
+    }
+
+    free(input);
+    ansilove_clean(&ctx);
+
+    return alive;
+}
+
+// takes connections one at a time and serves their jobs
+static void *serverWorker(void *arg)
+{
+    struct serverPool *pool = arg;
+    int connection;
+
+    for (;;) {
+        connection = accept(pool->listener, NULL, NULL);
+
+        if (connection == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            perror("Can't accept connection");
+            return NULL;
+        }
+
+        while (serverJob(connection, connection, pool->defaults, pool->threads)) {
+        }
+
+        close(connection);
+    }
+}
+
+int renderServer(const char *path, const struct ansilove_options *defaults,
+                 int32_t workers, int32_t threads)
+{
+    pthread_t threadIds[DRAW_THREADS_MAX];
+    struct sockaddr_un address;
+    struct serverPool pool;
+    struct fontStruct fontData;
+    struct stat st;
+    int32_t started = 0, loop;
+
+    // clients going away must not take the server with them
+    signal(SIGPIPE, SIG_IGN);
+
+    // the glyphs of the default font are ready before the first job
+    alSelectFont(&fontData, defaults->font);
+    alFontAtlas(&fontData, 8);
+    alFontAtlas(&fontData, 9);
+
+    // jobs on stdin are answered in order, one at a time
+    if (!strcmp(path, "-")) {
+        while (serverJob(STDIN_FILENO, STDOUT_FILENO, defaults, threads)) {
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fputs("\nSocket path too long.\n\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    strcpy(address.sun_path, path);
+
+    // a socket left behind by an earlier server is replaced
+    if (!lstat(path, &st) && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    pool.listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    pool.defaults = defaults;
+    pool.threads = threads;
+
+    if (pool.listener == -1 ||
+        bind(pool.listener, (struct sockaddr *)&address, sizeof(address)) == -1 ||
+        listen(pool.listener, SOMAXCONN) == -1) {
+        perror("Can't listen on socket");
+        return EXIT_FAILURE;
+    }
+
+    printf("\nListening on %s\n", path);
+    fflush(stdout);
+
+    if (workers > DRAW_THREADS_MAX) {
+        workers = DRAW_THREADS_MAX;
+    }
+
+    // the calling thread serves connections as well
+    for (loop = 1; loop < workers; loop++) {
+        if (pthread_create(&threadIds[started], NULL, serverWorker, &pool) == 0) {
+            started++;
+        }
+    }
+
+    serverWorker(&pool);
+
+    for (loop = 0; loop < started; loop++) {
+        pthread_join(threadIds[loop], NULL);
+    }
+
+    close(pool.listener);
+
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,51 @@
+//
+//  server.h
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "libansilove.h"
+
+#ifndef server_h
+#define server_h
+
+// upper limits for the options and the input of a job
+#define SERVER_OPTIONS_MAX 4096
+#define SERVER_INPUT_MAX   (64 * 1024 * 1024)
+
+// size of a response header, five numbers
+#define SERVER_RESPONSE_SIZE 20
+
+// Serves render jobs until it is killed, on a Unix domain socket at path
+// or on stdin and stdout when path is "-". Every number of the protocol
+// is an unsigned 32-bit big-endian integer. A job is
+//
+//   options length, options, input length, input
+//
+// where options are space separated key=value pairs: name, font, bits,
+// columns, mode, ice, level, filter, scale and format, as the command line
+// options take them. Anything not given is taken from defaults, name picks the
+// file type by its extension. The response is
+//
+//   status, microseconds, width, height, length, data
+//
+// status is an ANSILOVE_* error code, data is the PNG or raw frame or,
+// when status is not ANSILOVE_OK, the error message. A connection takes any number of
+// jobs. workers connections are served at once, each job is drawn on
+// threads threads.
+int renderServer(const char *path, const struct ansilove_options *defaults,
+                 int32_t workers, int32_t threads);
+
+#endif
@@ -11,7 +11,7 @@
 
 #include "strtolower.h"
 
-char *strtolower(char *str)
+char *alStrToLower(char *str)
 {
     char *p = str;
 
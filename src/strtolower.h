@@ -18,6 +18,6 @@
 
 // In-place modification of a string to be all lower case.
 
-char *strtolower(char *str);
+char *alStrToLower(char *str);
 
 #endif
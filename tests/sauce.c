@@ -0,0 +1,80 @@
+//
+//  sauce.c
+//  AnsiLove/C
+//
+//  Copyright (C) 2011-2017 Stefan Vogt, Brian Cassidy, and Frederic Cambus.
+//  All rights reserved.
+//
+//  This source code is licensed under the BSD 2-Clause License.
+//  See the file LICENSE for details.
+//
+
+// A BIN file of 4 rows followed by a SAUCE record with 255 comment lines
+// must render 4 rows high, the record and its comments are not part of
+// the image.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libansilove.h"
+
+#define COLUMNS  160
+#define ROWS     4
+#define COMMENTS 255
+
+int main(void)
+{
+    size_t cells = COLUMNS * ROWS * 2;
+    size_t length = cells + 1 + 5 + 64 * COMMENTS + 128;
+    unsigned char *buffer = calloc(length, 1);
+    unsigned char *record;
+    struct ansilove_ctx ctx;
+    struct ansilove_options options;
+    int failed = 0;
+
+    if (buffer == NULL) {
+        return 1;
+    }
+
+    // full blocks, white on blue
+    for (size_t loop = 0; loop < cells; loop += 2) {
+        buffer[loop] = 0xdb;
+        buffer[loop + 1] = 0x1f;
+    }
+
+    buffer[cells] = 0x1a;
+    memcpy(buffer + cells + 1, "COMNT", 5);
+    memset(buffer + cells + 6, ' ', 64 * COMMENTS);
+
+    record = buffer + length - 128;
+    memcpy(record, "SAUCE00", 7);
+    memset(record + 7, ' ', 35 + 20 + 20);
+    memcpy(record + 82, "20261017", 8);
+    record[94] = 5;
+    record[95] = COLUMNS / 2;
+    record[104] = COMMENTS;
+
+    ansilove_init(&ctx, &options);
+    ctx.buffer = buffer;
+    ctx.length = length;
+    options.type = ANSILOVE_BINARY;
+    options.columns = COLUMNS;
+    ctx.outputs[0].format = ANSILOVE_RGBA;
+
+    if (ansilove_render(&ctx, &options) != ANSILOVE_OK) {
+        fprintf(stderr, "render: %s\n", ansilove_error(&ctx));
+        failed = 1;
+    } else if (ctx.outputs[0].width != COLUMNS * 8 ||
+        ctx.outputs[0].height != ROWS * 16) {
+        fprintf(stderr, "rendered %dx%d, expected %dx%d\n",
+            ctx.outputs[0].width, ctx.outputs[0].height,
+            COLUMNS * 8, ROWS * 16);
+        failed = 1;
+    }
+
+    ansilove_clean(&ctx);
+    free(buffer);
+
+    return failed;
+}